@@ -8,14 +8,19 @@
 
 #include <zephyr/kernel.h>
 #include <zmk/event_manager.h>
+#include <zmk/keystroke_stats.h>
 
 /**
  * @brief Event raised when keystroke statistics are updated
  *
- * This event is raised periodically (not on every keystroke) to notify
- * UI components that they should update their display of keystroke statistics.
+ * This event is raised when the statistics changed meaningfully (see
+ * CONFIG_ZMK_KEYSTROKE_STATS_EVENT_KEYSTROKE_DELTA and
+ * CONFIG_ZMK_KEYSTROKE_STATS_EVENT_MIN_INTERVAL_MS), not on every keystroke,
+ * to notify UI components that they should update their display.
  *
- * The event contains the current statistics values for efficient display updates.
+ * The event carries the values UIs show most, so listeners rarely need
+ * zmk_keystroke_stats_get(), and a mask of the fields that changed since the
+ * previous event. The first event after boot has every bit set.
  */
 struct zmk_keystroke_stats_changed {
     /** Total keystrokes across all time */
@@ -24,6 +29,19 @@ struct zmk_keystroke_stats_changed {
     uint32_t today_keystrokes;
     /** Yesterday's keystroke count */
     uint32_t yesterday_keystrokes;
+    /** Current session keystrokes, 0 without session tracking */
+    uint32_t session_keystrokes;
+    /** Current day number (see zmk_keystroke_stats.current_uptime_day) */
+    uint16_t day;
+    /** Current words per minute, 0 without WPM tracking */
+    uint8_t current_wpm;
+    /** Peak WPM of the current session, 0 without WPM tracking */
+    uint8_t peak_wpm;
+    /**
+     * ZMK_KEYSTROKE_STATS_CHANGED_* bits of the fields that changed. KEYS and
+     * HISTORY are only set on the first event.
+     */
+    uint8_t changed;
 };
 
 ZMK_EVENT_DECLARE(zmk_keystroke_stats_changed);
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <zephyr/kernel.h>
+#include <zephyr/sys/slist.h>
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -49,19 +50,117 @@ struct zmk_keystroke_stats_key_entry {
     uint32_t count;
 };
 
+/**
+ * @brief Smallest day number that is a calendar day (2000-01-01)
+ *
+ * Day numbers below this are uptime-based counters (time never set by host).
+ */
+#define ZMK_KEYSTROKE_STATS_CALENDAR_DAY_MIN 10957
+
+/**
+ * @brief Largest keystroke count a daily entry can hold (24-bit)
+ */
+#define ZMK_KEYSTROKE_STATS_DAILY_COUNT_MAX 0xFFFFFF
+
 /**
  * @brief Daily statistics entry
+ *
+ * Packed into 5 bytes. Use zmk_keystroke_stats_daily_entry_get_keystrokes()
+ * and zmk_keystroke_stats_daily_entry_set() rather than accessing the count
+ * bytes directly.
  */
 struct zmk_keystroke_stats_daily_entry {
-    /** Year (since epoch, or uptime-based identifier) */
-    uint16_t year;
-    /** Month (1-12, or 0 if uptime-based) */
-    uint8_t month;
-    /** Day (1-31, or uptime day counter) */
-    uint8_t day;
-    /** Number of keystrokes on this day */
-    uint32_t keystrokes;
-};
+    /** Day number (days since 1970-01-01, or uptime day counter) */
+    uint16_t day;
+    /** Number of keystrokes on this day (24-bit little-endian, saturating) */
+    uint8_t keystrokes[3];
+} __packed;
+
+/**
+ * @brief Get keystroke count of a daily entry
+ */
+static inline uint32_t
+zmk_keystroke_stats_daily_entry_get_keystrokes(const struct zmk_keystroke_stats_daily_entry *entry) {
+    return (uint32_t)entry->keystrokes[0] | ((uint32_t)entry->keystrokes[1] << 8) |
+           ((uint32_t)entry->keystrokes[2] << 16);
+}
+
+/**
+ * @brief Fill a daily entry, saturating the count at 24 bits
+ */
+static inline void
+zmk_keystroke_stats_daily_entry_set(struct zmk_keystroke_stats_daily_entry *entry, uint16_t day,
+                                    uint32_t keystrokes) {
+    keystrokes = MIN(keystrokes, ZMK_KEYSTROKE_STATS_DAILY_COUNT_MAX);
+
+    entry->day = day;
+    entry->keystrokes[0] = (uint8_t)keystrokes;
+    entry->keystrokes[1] = (uint8_t)(keystrokes >> 8);
+    entry->keystrokes[2] = (uint8_t)(keystrokes >> 16);
+}
+
+/**
+ * @brief Convert a calendar day number to a date
+ *
+ * @param day Days since 1970-01-01
+ * @param year Pointer to store the year (e.g. 2025)
+ * @param month Pointer to store the month (1-12)
+ * @param mday Pointer to store the day of month (1-31)
+ * @return 0 on success, -EINVAL if day is an uptime-based counter
+ */
+int zmk_keystroke_stats_day_to_date(uint16_t day, uint16_t *year, uint8_t *month, uint8_t *mday);
+
+/**
+ * @brief Convert a date to a calendar day number
+ *
+ * @return Days since 1970-01-01, or 0 if the date is out of range or does not
+ *         exist (e.g. February 30)
+ */
+uint16_t zmk_keystroke_stats_date_to_day(uint16_t year, uint8_t month, uint8_t mday);
+
+/**
+ * @brief Longest text of zmk_keystroke_stats_format_count() ("999.9K")
+ */
+#define ZMK_KEYSTROKE_STATS_COUNT_WIDTH 6
+
+/**
+ * @brief Buffer size for zmk_keystroke_stats_format_count(), including the NUL
+ */
+#define ZMK_KEYSTROKE_STATS_COUNT_STR_LEN (ZMK_KEYSTROKE_STATS_COUNT_WIDTH + 1)
+
+/**
+ * @brief Format a count for display
+ *
+ * - 0-9999: as-is (e.g. "1234")
+ * - 10000+: one decimal with a K, M or G suffix, ".0" dropped
+ *   (e.g. "12.3K", "999K", "4.2G")
+ *
+ * Does not use snprintf. The text is at most ZMK_KEYSTROKE_STATS_COUNT_WIDTH
+ * characters and unpadded; see zmk_keystroke_stats_format_count_padded()
+ * for a fixed width field.
+ *
+ * @param value Count to format
+ * @param buf Output buffer, NUL-terminated on success
+ * @param size Size of buf
+ * @return Length of the text, 0 if buf is too small
+ */
+size_t zmk_keystroke_stats_format_count(uint32_t value, char *buf, size_t size);
+
+/**
+ * @brief Format a count right-aligned in a fixed width field
+ *
+ * Like zmk_keystroke_stats_format_count(), with leading spaces up to width
+ * characters. With width ZMK_KEYSTROKE_STATS_COUNT_WIDTH every count has
+ * the same length, so a display can draw it at a fixed position.
+ *
+ * @param value Count to format
+ * @param buf Output buffer, NUL-terminated on success
+ * @param size Size of buf, at least width + 1
+ * @param width Field width; longer text is not cut
+ * @return Length of the text, 0 if buf is too small
+ */
+size_t zmk_keystroke_stats_format_count_padded(uint32_t value, char *buf, size_t size,
+                                               size_t width);
 
 /**
  * @brief Complete keystroke statistics structure
@@ -109,10 +208,65 @@ struct zmk_keystroke_stats {
     /** Number of valid entries in daily_stats array */
     uint8_t daily_stats_count;
 
-    /** Current uptime day (for day rollover tracking) */
+    /**
+     * Current day number (for day rollover tracking)
+     *
+     * Days since 1970-01-01 in local time once the host has set the time,
+     * otherwise an uptime-based counter that continues across reboots.
+     */
     uint16_t current_uptime_day;
 };
 
+/**
+ * @brief Flash write accounting
+ *
+ * Counters and maxima are lifetime values stored with the statistics. They
+ * reach flash with the next checkpoint, so the last few saves before a
+ * power loss may be missing from them.
+ */
+struct zmk_keystroke_stats_flash_telemetry {
+    /** Saves started by the scheduler, manual requests or power events */
+    uint32_t saves_attempted;
+
+    /** Saves skipped because nothing changed since the last one */
+    uint32_t saves_skipped;
+
+    /** Saves that failed */
+    uint32_t save_failures;
+
+    /** Values written to the settings backend */
+    uint32_t writes;
+
+    /** Bytes successfully written to the settings backend */
+    uint32_t bytes_written;
+
+    /** Longest save in microseconds */
+    uint32_t max_save_us;
+
+    /** Longest single settings write in microseconds */
+    uint32_t max_write_us;
+
+    /** Duration of the last save in microseconds, 0 if none since boot */
+    uint32_t last_save_us;
+
+    /** Time since the last successful save, UINT32_MAX if none since boot */
+    uint32_t since_last_save_ms;
+};
+
+/*
+ * Groups of statistics fields, used as change masks and subscriber
+ * interests. KEYS covers top_keys and per-key counts, HISTORY daily_stats.
+ */
+#define ZMK_KEYSTROKE_STATS_CHANGED_TODAY BIT(0)
+#define ZMK_KEYSTROKE_STATS_CHANGED_YESTERDAY BIT(1)
+#define ZMK_KEYSTROKE_STATS_CHANGED_TOTAL BIT(2)
+#define ZMK_KEYSTROKE_STATS_CHANGED_SESSION BIT(3)
+#define ZMK_KEYSTROKE_STATS_CHANGED_WPM BIT(4)
+#define ZMK_KEYSTROKE_STATS_CHANGED_DAY BIT(5)
+#define ZMK_KEYSTROKE_STATS_CHANGED_KEYS BIT(6)
+#define ZMK_KEYSTROKE_STATS_CHANGED_HISTORY BIT(7)
+#define ZMK_KEYSTROKE_STATS_CHANGED_ALL BIT_MASK(8)
+
 /**
  * @brief Callback function type for statistics updates
  *
@@ -130,7 +284,8 @@ typedef void (*zmk_keystroke_stats_callback_t)(const struct zmk_keystroke_stats
  * Populates the provided structure with current statistics data.
  *
  * @param stats Pointer to structure to populate
- * @return 0 on success, negative errno on failure
+ * @return 0 on success, -EAGAIN while the stored statistics are still being
+ *         loaded after boot, negative errno on other failures
  */
 int zmk_keystroke_stats_get(struct zmk_keystroke_stats *stats);
 
@@ -141,7 +296,8 @@ int zmk_keystroke_stats_get(struct zmk_keystroke_stats *stats);
  *
  * @param position Key position index
  * @param count Pointer to store the count
- * @return 0 on success, -ENOTSUP if heatmap disabled, -EINVAL if position invalid
+ * @return 0 on success, -ENOTSUP if heatmap disabled, -EINVAL if position invalid,
+ *         -EAGAIN while the stored statistics are still being loaded
  */
 int zmk_keystroke_stats_get_key_count(uint32_t position, uint32_t *count);
 
@@ -158,12 +314,21 @@ int zmk_keystroke_stats_get_key_count(uint32_t position, uint32_t *count);
  */
 int zmk_keystroke_stats_save(void);
 
+/**
+ * @brief Get flash write accounting
+ *
+ * @param telemetry Pointer to structure to populate
+ * @return 0 on success, -EINVAL if telemetry is NULL
+ */
+int zmk_keystroke_stats_get_flash_telemetry(struct zmk_keystroke_stats_flash_telemetry *telemetry);
+
 /**
  * @brief Reset statistics
  *
  * @param reset_total If true, resets total_keystrokes as well.
  *                    If false, only resets today/yesterday/session stats.
- * @return 0 on success, negative errno on failure
+ * @return 0 on success, -EAGAIN while the stored statistics are still being
+ *         loaded, negative errno on other failures
  */
 int zmk_keystroke_stats_reset(bool reset_total);
 
@@ -173,9 +338,14 @@ int zmk_keystroke_stats_reset(bool reset_total);
  * The callback will be invoked whenever statistics change significantly
  * (e.g., keystroke count increments, WPM updates, day rollover).
  *
+ * Deprecated, kept for compatibility: callbacks get every change with a full
+ * snapshot, and there are only CONFIG_ZMK_KEYSTROKE_STATS_MAX_CALLBACKS of
+ * them. Use zmk_keystroke_stats_subscribe(), which has no limit.
+ *
  * @param callback Callback function
  * @param user_data User data to pass to callback
- * @return 0 on success, negative errno on failure
+ * @return 0 on success, -EINVAL without callback, -ENOMEM if all
+ *         CONFIG_ZMK_KEYSTROKE_STATS_MAX_CALLBACKS are registered
  */
 int zmk_keystroke_stats_register_callback(zmk_keystroke_stats_callback_t callback,
                                             void *user_data);
@@ -189,57 +359,76 @@ int zmk_keystroke_stats_register_callback(zmk_keystroke_stats_callback_t callbac
 int zmk_keystroke_stats_unregister_callback(zmk_keystroke_stats_callback_t callback);
 
 /**
- * @brief Persistent data structure for settings storage
+ * @brief Statistics subscriber
  *
- * This structure contains all fields that are persisted to non-volatile storage.
- * The settings layer uses the accessor functions below to get/set this data.
+ * Owned by the caller and linked into the subscriber list, so it must stay
+ * valid until unsubscribed (usually static). Fill in the public fields
+ * before zmk_keystroke_stats_subscribe().
  *
- * Version field allows for future data migration.
+ * The callback runs in the keystroke listener (or on the system work queue
+ * for notifications held back by min_interval_ms) and must be short: the
+ * next keystroke is not dispatched until it returns. It runs without the
+ * statistics lock, so it may call the getters, and one callback at a time.
+ * The snapshot always has the counters, WPM and day; top_keys and
+ * daily_stats are only filled if some subscriber being notified is
+ * interested in KEYS or HISTORY.
  */
-struct zmk_keystroke_stats_persist_data {
-    uint8_t version;
-    uint32_t total_keystrokes;
-    uint32_t today_keystrokes;
-    uint32_t yesterday_keystrokes;
-    uint16_t current_uptime_day;
-
-#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_WPM
-    uint8_t peak_wpm;
-    uint32_t total_typing_time_ms;
-#endif
-
-#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_KEY_HEATMAP
-    uint32_t key_counts[CONFIG_ZMK_KEYSTROKE_STATS_MAX_KEY_POSITIONS];
-#endif
+struct zmk_keystroke_stats_subscriber {
+    /** Called when fields of interest changed */
+    zmk_keystroke_stats_callback_t callback;
+    /** Passed to the callback */
+    void *user_data;
+    /** ZMK_KEYSTROKE_STATS_CHANGED_* bits to be notified about, 0 for all */
+    uint8_t interest;
+    /** Minimum time between notifications, changes in between are folded */
+    uint32_t min_interval_ms;
+
+    /* Private, managed by the statistics module */
+    sys_snode_t node;
+    uint8_t pending;
+    bool notifying;
+    int64_t last_notify_ms;
+};
 
-#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_DAILY_HISTORY
-    struct zmk_keystroke_stats_daily_entry daily_history[CONFIG_ZMK_KEYSTROKE_STATS_DAILY_HISTORY_DAYS];
-    uint8_t daily_history_count;
-#endif
-} __packed;
+/**
+ * @brief Add a subscriber
+ *
+ * @param subscriber Subscriber with callback set
+ * @return 0 on success, -EINVAL without callback, -EALREADY if subscribed
+ */
+int zmk_keystroke_stats_subscribe(struct zmk_keystroke_stats_subscriber *subscriber);
 
 /**
- * @brief Get persistent data for settings storage
+ * @brief Remove a subscriber
  *
- * This function is used by the settings layer to retrieve data that should
- * be persisted to non-volatile storage. The function is thread-safe and
- * uses mutex protection internally.
+ * May be called from the subscriber's own callback.
  *
- * @param data Pointer to structure to populate with persistent data
- * @return 0 on success, negative errno on failure
+ * @return 0 on success, -ENOENT if not subscribed
  */
-int zmk_keystroke_stats_get_persist_data(struct zmk_keystroke_stats_persist_data *data);
+int zmk_keystroke_stats_unsubscribe(struct zmk_keystroke_stats_subscriber *subscriber);
 
 /**
- * @brief Load persistent data from settings storage
+ * @brief Set wall-clock time from the host
+ *
+ * Keyboards have no RTC. Once the host provides the time (shell, or any RPC
+ * transport calling this function), day rollover follows the local calendar
+ * day instead of uptime, so reboots and power cycles no longer cause
+ * spurious rollovers. If calendar days have passed since the stored day,
+ * a rollover is applied immediately.
  *
- * This function is used by the settings layer to restore previously saved data.
- * The function validates the data version and is thread-safe.
+ * @param epoch_s Seconds since 1970-01-01 UTC
+ * @param utc_offset_min Local time offset from UTC in minutes (-720..840)
+ * @return 0 on success, -EINVAL if arguments are out of range
+ */
+int zmk_keystroke_stats_set_time(int64_t epoch_s, int16_t utc_offset_min);
+
+/**
+ * @brief Get current wall-clock time
  *
- * @param data Pointer to persistent data to load
- * @return 0 on success, negative errno on failure (-EINVAL for invalid version)
+ * @param epoch_s Pointer to store seconds since 1970-01-01 UTC
+ * @return 0 on success, -EAGAIN if the time has not been set since boot
  */
-int zmk_keystroke_stats_load_persist_data(const struct zmk_keystroke_stats_persist_data *data);
+int zmk_keystroke_stats_get_time(int64_t *epoch_s);
 
 /**
  * @brief Macro for defining a keystroke statistics UI implementation
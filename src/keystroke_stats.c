@@ -9,135 +9,106 @@
 #include <zephyr/device.h>
 #include <zephyr/init.h>
 #include <zmk/event_manager.h>
-#include <zmk/events/keycode_state_changed.h>
+#include <zmk/events/position_state_changed.h>
 #include <zmk/events/keystroke_stats_changed.h>
 #include <zmk/keystroke_stats.h>
 
+#include "keystroke_stats_internal.h"
+
 LOG_MODULE_REGISTER(zmk_keystroke_stats, CONFIG_ZMK_KEYSTROKE_STATS_LOG_LEVEL);
 
 /* Forward declarations */
 static void update_wpm(void);
 static void check_day_rollover(void);
-static void notify_callbacks(void);
+static void notify_callbacks(uint8_t changed);
+static void dispatch(void);
+static void request_changed_event(bool force);
+static void fill_snapshot(struct zmk_keystroke_stats *stats, uint8_t fields);
 static void schedule_save(void);
+static void mark_dirty(uint8_t sections);
 
-/* Internal state structure */
-static struct {
-    /* Core statistics */
-    uint32_t total_keystrokes;
-    uint32_t today_keystrokes;
-    uint32_t yesterday_keystrokes;
-
-#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_SESSION_TRACKING
-    uint32_t session_keystrokes;
-    uint32_t session_start_time;
-#endif
+/* Internal state (see keystroke_stats_internal.h) */
+static struct keystroke_stats_state state = {
+    .initialized = false,
+};
 
-#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_WPM
-    uint8_t current_wpm;
-    uint8_t average_wpm;
-    uint8_t peak_wpm;
-    uint32_t total_typing_time_ms;
-
-    /* WPM calculation window */
-    struct {
-        uint32_t keystrokes[10];  /* Ring buffer of keystroke counts */
-        uint32_t timestamps[10];  /* Corresponding timestamps */
-        uint8_t head;             /* Next write position */
-        uint8_t count;            /* Number of valid entries */
-    } wpm_window;
-#endif
+/* Mutex for thread-safe access */
+K_MUTEX_DEFINE(stats_mutex);
 
-#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_KEY_HEATMAP
-    uint32_t key_counts[CONFIG_ZMK_KEYSTROKE_STATS_MAX_KEY_POSITIONS];
-#endif
+struct keystroke_stats_state *keystroke_stats_state_get(void) {
+    return &state;
+}
 
+void keystroke_stats_history_insert(uint16_t day, uint32_t keystrokes) {
 #if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_DAILY_HISTORY
-    struct zmk_keystroke_stats_daily_entry daily_history[CONFIG_ZMK_KEYSTROKE_STATS_DAILY_HISTORY_DAYS];
-    uint8_t daily_history_count;
-#endif
-
-    /* Day tracking (uptime-based) */
-    uint16_t current_uptime_day;
-    uint32_t last_keystroke_time;
+    /* Entries are ordered by day; new days normally go at the end */
+    int pos = state.daily_history_count;
+    while (pos > 0 && state.daily_history[pos - 1].day >= day) {
+        pos--;
+    }
 
-    /* Callback system */
-    struct {
-        zmk_keystroke_stats_callback_t callback;
-        void *user_data;
-    } callbacks[4];  /* Support up to 4 registered callbacks */
-    uint8_t callback_count;
+    if (pos < state.daily_history_count && state.daily_history[pos].day == day) {
+        zmk_keystroke_stats_daily_entry_set(&state.daily_history[pos], day, keystrokes);
+        return;
+    }
 
-    /* Save management */
-    struct k_work_delayable save_work;
-    bool save_pending;
-    bool initialized;
+    if (state.daily_history_count >= CONFIG_ZMK_KEYSTROKE_STATS_DAILY_HISTORY_DAYS) {
+        if (pos == 0) {
+            /* Older than everything we keep */
+            return;
+        }
 
-} state = {
-    .initialized = false,
-    .callback_count = 0,
-};
+        /* Drop the oldest entry to make room */
+        memmove(&state.daily_history[0], &state.daily_history[1],
+                (pos - 1) * sizeof(state.daily_history[0]));
+        pos--;
+    } else {
+        memmove(&state.daily_history[pos + 1], &state.daily_history[pos],
+                (state.daily_history_count - pos) * sizeof(state.daily_history[0]));
+        state.daily_history_count++;
+    }
 
-/* Mutex for thread-safe access */
-K_MUTEX_DEFINE(stats_mutex);
+    zmk_keystroke_stats_daily_entry_set(&state.daily_history[pos], day, keystrokes);
+#endif
+}
 
 /**
- * @brief Get current uptime day
+ * @brief Move today's count into history and start a new day
  *
- * Calculates which "day" we're in based on uptime and configured rollover hour.
- * Day 0 = first 24 hours, Day 1 = next 24 hours, etc.
+ * @param new_day Day number that is starting now
  */
-static uint16_t get_uptime_day(void) {
-    uint32_t uptime_ms = k_uptime_get();
-    uint32_t uptime_hours = uptime_ms / 3600000;
+static void apply_day_rollover(uint16_t new_day) {
+    LOG_INF("Day rollover detected: day %u -> %u",
+            state.current_uptime_day, new_day);
 
-    /* Adjust for rollover hour */
-    int32_t adjusted_hours = uptime_hours - CONFIG_ZMK_KEYSTROKE_STATS_DAY_ROLLOVER_HOUR;
-    if (adjusted_hours < 0) {
-        adjusted_hours = 0;
-    }
+    /* Add the finished day to history */
+    keystroke_stats_history_insert(state.current_uptime_day, state.today_keystrokes);
+    keystroke_stats_journal_note_history(state.current_uptime_day, state.today_keystrokes);
 
-    return (uint16_t)(adjusted_hours / 24);
+    /* Roll over stats. If whole days were skipped (keyboard off), yesterday had no keystrokes */
+    state.yesterday_keystrokes =
+        (new_day == (uint16_t)(state.current_uptime_day + 1)) ? state.today_keystrokes : 0;
+    state.today_keystrokes = 0;
+    state.current_uptime_day = new_day;
+    mark_dirty(BIT(KEYSTROKE_STATS_SECTION_CORE) | BIT(KEYSTROKE_STATS_SECTION_HISTORY));
+
+    /* Trigger save and notify */
+    schedule_save();
+    notify_callbacks(ZMK_KEYSTROKE_STATS_CHANGED_TODAY | ZMK_KEYSTROKE_STATS_CHANGED_YESTERDAY |
+                     ZMK_KEYSTROKE_STATS_CHANGED_DAY | ZMK_KEYSTROKE_STATS_CHANGED_HISTORY);
 }
 
 /**
  * @brief Check if day has rolled over and update statistics
+ *
+ * Cheap on the hot path: the time anchor only recomputes the day once the
+ * cached end-of-day boundary has passed.
  */
 static void check_day_rollover(void) {
-    uint16_t current_day = get_uptime_day();
+    uint16_t current_day = keystroke_stats_time_get_day(k_uptime_get());
 
     if (current_day != state.current_uptime_day) {
-        LOG_INF("Day rollover detected: day %u -> %u",
-                state.current_uptime_day, current_day);
-
-#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_DAILY_HISTORY
-        /* Add yesterday to history */
-        if (state.daily_history_count < CONFIG_ZMK_KEYSTROKE_STATS_DAILY_HISTORY_DAYS) {
-            state.daily_history[state.daily_history_count].year = 0;  /* Uptime-based */
-            state.daily_history[state.daily_history_count].month = 0;
-            state.daily_history[state.daily_history_count].day = (uint8_t)state.current_uptime_day;
-            state.daily_history[state.daily_history_count].keystrokes = state.today_keystrokes;
-            state.daily_history_count++;
-        } else {
-            /* Shift history and add new entry */
-            for (int i = 0; i < CONFIG_ZMK_KEYSTROKE_STATS_DAILY_HISTORY_DAYS - 1; i++) {
-                state.daily_history[i] = state.daily_history[i + 1];
-            }
-            state.daily_history[CONFIG_ZMK_KEYSTROKE_STATS_DAILY_HISTORY_DAYS - 1].year = 0;
-            state.daily_history[CONFIG_ZMK_KEYSTROKE_STATS_DAILY_HISTORY_DAYS - 1].month = 0;
-            state.daily_history[CONFIG_ZMK_KEYSTROKE_STATS_DAILY_HISTORY_DAYS - 1].day = (uint8_t)state.current_uptime_day;
-            state.daily_history[CONFIG_ZMK_KEYSTROKE_STATS_DAILY_HISTORY_DAYS - 1].keystrokes = state.today_keystrokes;
-        }
-#endif
-
-        /* Roll over stats */
-        state.yesterday_keystrokes = state.today_keystrokes;
-        state.today_keystrokes = 0;
-        state.current_uptime_day = current_day;
-
-        /* Trigger save and notify */
-        schedule_save();
-        notify_callbacks();
+        apply_day_rollover(current_day);
     }
 }
 
@@ -182,6 +153,7 @@ static void update_wpm(void) {
         /* Update peak */
         if (state.current_wpm > state.peak_wpm) {
             state.peak_wpm = state.current_wpm;
+            mark_dirty(BIT(KEYSTROKE_STATS_SECTION_WPM));
         }
     } else {
         state.current_wpm = 0;
@@ -218,81 +190,324 @@ static void check_session_timeout(void) {
         state.peak_wpm = 0;
         state.wpm_window.count = 0;
         state.wpm_window.head = 0;
+        mark_dirty(BIT(KEYSTROKE_STATS_SECTION_WPM));
 #endif
     }
 }
 #endif /* CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_SESSION_TRACKING */
 
+/*
+ * Subscribers
+ *
+ * Each change is recorded as pending on the subscribers interested in it,
+ * with stats_mutex held. Once it is released, subscribers with pending
+ * changes and no min_interval_ms holding them back are notified together
+ * with one snapshot, holding only the sections (top keys, history) they need
+ * between them. Held back subscribers are notified by a delayed work item
+ * when the earliest of them is due.
+ *
+ * Callbacks run without stats_mutex, so they never hold up keystrokes
+ * counted on other threads or saves, and may call the getters. notify_mutex
+ * runs them one at a time and keeps the subscriber list stable meanwhile;
+ * it is always taken before stats_mutex.
+ */
+
+static K_MUTEX_DEFINE(notify_mutex);
+
+static uint8_t subscriber_interest(const struct zmk_keystroke_stats_subscriber *sub) {
+    return sub->interest != 0 ? sub->interest : ZMK_KEYSTROKE_STATS_CHANGED_ALL;
+}
+
+static bool subscriber_due(const struct zmk_keystroke_stats_subscriber *sub, int64_t now) {
+    return sub->pending != 0 && now - sub->last_notify_ms >= sub->min_interval_ms;
+}
+
+static void notify_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(notify_work, notify_work_handler);
+
 /**
- * @brief Notify all registered callbacks
+ * @brief Record changes as pending on the interested subscribers
+ *
+ * Called with stats_mutex held, dispatch() notifies them once it is released.
+ *
+ * @param changed ZMK_KEYSTROKE_STATS_CHANGED_* bits of what changed
  */
-static void notify_callbacks(void) {
-    if (state.callback_count == 0) {
-        return;
+static void note_changes(uint8_t changed) {
+    struct zmk_keystroke_stats_subscriber *sub;
+
+    SYS_SLIST_FOR_EACH_CONTAINER(&state.subscribers, sub, node) {
+        sub->pending |= changed & subscriber_interest(sub);
     }
+}
 
+/**
+ * @brief Notify the subscribers that are due
+ *
+ * Must be called without stats_mutex held.
+ */
+static void dispatch(void) {
+    struct zmk_keystroke_stats_subscriber *sub, *next;
     struct zmk_keystroke_stats stats;
-    if (zmk_keystroke_stats_get(&stats) == 0) {
-        for (int i = 0; i < state.callback_count; i++) {
-            if (state.callbacks[i].callback != NULL) {
-                state.callbacks[i].callback(&stats, state.callbacks[i].user_data);
-            }
+    int64_t now = k_uptime_get();
+    int64_t next_due = INT64_MAX;
+    uint8_t fields = 0;
+
+    k_mutex_lock(&notify_mutex, K_FOREVER);
+    k_mutex_lock(&stats_mutex, K_FOREVER);
+
+    SYS_SLIST_FOR_EACH_CONTAINER(&state.subscribers, sub, node) {
+        if (subscriber_due(sub, now)) {
+            fields |= subscriber_interest(sub);
+            sub->pending = 0;
+            sub->last_notify_ms = now;
+            sub->notifying = true;
+        } else if (sub->pending != 0) {
+            next_due = MIN(next_due, sub->last_notify_ms + sub->min_interval_ms);
         }
     }
+
+    if (fields != 0) {
+        fill_snapshot(&stats, fields);
+    }
+
+    if (next_due != INT64_MAX) {
+        k_work_reschedule(&notify_work, K_MSEC(next_due - now));
+    }
+
+    k_mutex_unlock(&stats_mutex);
+
+    /* Callbacks may unsubscribe themselves */
+    SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&state.subscribers, sub, next, node) {
+        if (sub->notifying) {
+            sub->notifying = false;
+            sub->callback(&stats, sub->user_data);
+        }
+    }
+
+    k_mutex_unlock(&notify_mutex);
+}
+
+static void notify_work_handler(struct k_work *work) {
+    ARG_UNUSED(work);
+    dispatch();
 }
 
 /**
- * @brief Work handler for delayed save
+ * @brief Record a change for subscribers and event listeners
+ *
+ * Called with stats_mutex held, dispatch() notifies subscribers once it is
+ * released.
+ *
+ * @param changed ZMK_KEYSTROKE_STATS_CHANGED_* bits of what changed
  */
-static void save_work_handler(struct k_work *work) {
-    /* This will be implemented in keystroke_stats_settings.c */
-    extern int keystroke_stats_save_to_settings(void);
+static void notify_callbacks(uint8_t changed) {
+    request_changed_event(false);
+    note_changes(changed);
+}
 
+/*
+ * Save scheduling
+ *
+ * Nothing is written on a fixed period. A save is scheduled when either the
+ * oldest unsaved change reaches CONFIG_ZMK_KEYSTROKE_STATS_SAVE_INTERVAL_MS
+ * or CONFIG_ZMK_KEYSTROKE_STATS_SAVE_MAX_UNSAVED_KEYSTROKES keystrokes are
+ * unsaved, which bounds what a power loss can cost. Saves with no changes
+ * since the last successful one are skipped.
+ */
+
+/* Rated erase cycles assumed for lifespan projections */
+#define FLASH_ENDURANCE_CYCLES 10000
+#define MS_PER_DAY (24 * 3600 * 1000LL)
+
+static void save_max_age_handler(struct k_timer *timer) {
+    ARG_UNUSED(timer);
+    LOG_DBG("Unsaved changes reached max age");
+    schedule_save();
+}
+
+K_TIMER_DEFINE(save_max_age_timer, save_max_age_handler, NULL);
+
+/**
+ * @brief Record a change that needs saving
+ *
+ * Called with stats_mutex held. The first change after a save starts the
+ * max-age timer.
+ */
+static void mark_dirty(uint8_t sections) {
+    state.dirty_sections |= sections;
+    keystroke_stats_retained_changed();
+
+    if (state.change_seq == state.saved_seq) {
+        state.unsaved_since_ms = k_uptime_get();
+        k_timer_start(&save_max_age_timer,
+                      K_MSEC(CONFIG_ZMK_KEYSTROKE_STATS_SAVE_INTERVAL_MS), K_NO_WAIT);
+    }
+    state.change_seq++;
+}
+
+/**
+ * @brief Projected flash lifespan in days from the measured save rate
+ *
+ * Assumes each save costs one erase cycle, like the build-time estimate.
+ * Called with stats_mutex held.
+ *
+ * @return Days, or 0 before the first save
+ */
+static uint32_t projected_lifespan_days(void) {
+    if (state.save_count == 0) {
+        return 0;
+    }
+
+    int64_t ms_per_save = k_uptime_get() / state.save_count;
+
+    return (uint32_t)MIN(ms_per_save * FLASH_ENDURANCE_CYCLES / MS_PER_DAY, UINT32_MAX);
+}
+
+void keystroke_stats_save_status_get(struct keystroke_stats_save_status *status) {
+    k_mutex_lock(&stats_mutex, K_FOREVER);
+
+    status->unsaved_keystrokes = state.unsaved_keystrokes;
+    status->unsaved_age_ms = state.change_seq == state.saved_seq
+                                 ? 0
+                                 : (uint32_t)(k_uptime_get() - state.unsaved_since_ms);
+    status->save_count = state.save_count;
+    status->projected_lifespan_days = projected_lifespan_days();
+
+    k_mutex_unlock(&stats_mutex);
+}
+
+/* Serialises saves from the work item and from power events */
+K_MUTEX_DEFINE(save_mutex);
+
+/*
+ * Saves run on their own low-priority queue: a settings write can block for
+ * a flash erase (tens of ms during NVS garbage collection), which on the
+ * system work queue would hold up every other ZMK work item, HID reports
+ * included.
+ */
+K_THREAD_STACK_DEFINE(save_work_q_stack, CONFIG_ZMK_KEYSTROKE_STATS_SAVE_THREAD_STACK_SIZE);
+static struct k_work_q save_work_q;
+
+/**
+ * @brief Save now if anything changed since the last successful save
+ */
+static int save_if_changed(void) {
+    k_mutex_lock(&save_mutex, K_FOREVER);
+
+    /*
+     * Accounting alone does not mark anything dirty: the counters ride along
+     * with the next checkpoint instead of causing saves of their own.
+     */
+    k_mutex_lock(&stats_mutex, K_FOREVER);
+    uint32_t seq = state.change_seq;
+    uint32_t keystrokes = state.unsaved_keystrokes;
+    bool changed = seq != state.saved_seq;
+    state.save_pending = false;
+    state.flash.saves_attempted++;
+    if (!changed) {
+        state.flash.saves_skipped++;
+    }
+    k_mutex_unlock(&stats_mutex);
+
+    if (!changed) {
+        LOG_DBG("Nothing changed since last save, skipping");
+        k_mutex_unlock(&save_mutex);
+        return 0;
+    }
+
+    uint32_t start = k_cycle_get_32();
     int ret = keystroke_stats_save_to_settings();
+    uint32_t duration_us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+
+    k_mutex_lock(&stats_mutex, K_FOREVER);
+    state.flash.last_save_us = duration_us;
+    state.flash.max_save_us = MAX(state.flash.max_save_us, duration_us);
     if (ret == 0) {
-        LOG_INF("Statistics saved to persistent storage");
-        state.save_pending = false;
+        state.saved_seq = seq;
+        state.unsaved_keystrokes -= keystrokes;
+        state.save_count++;
+        state.last_save_ms = k_uptime_get();
+
+        if (state.change_seq == state.saved_seq) {
+            k_timer_stop(&save_max_age_timer);
+        } else {
+            /* Changes arrived while writing: they start a new window */
+            state.unsaved_since_ms = k_uptime_get();
+            k_timer_start(&save_max_age_timer,
+                          K_MSEC(CONFIG_ZMK_KEYSTROKE_STATS_SAVE_INTERVAL_MS), K_NO_WAIT);
+        }
+
+        LOG_INF("Statistics saved in %u us (%u saves since boot, projected flash lifespan %u days)",
+                duration_us, state.save_count, projected_lifespan_days());
     } else {
+        state.flash.save_failures++;
+        /* Retry once the max age is reached again */
+        k_timer_start(&save_max_age_timer,
+                      K_MSEC(CONFIG_ZMK_KEYSTROKE_STATS_SAVE_INTERVAL_MS), K_NO_WAIT);
         LOG_ERR("Failed to save statistics: %d", ret);
     }
+    k_mutex_unlock(&stats_mutex);
+
+    k_mutex_unlock(&save_mutex);
+
+    return ret;
 }
 
 /**
- * @brief Schedule a save operation (with debounce)
+ * @brief Work handler for delayed save
  */
-static void schedule_save(void) {
+static void save_work_handler(struct k_work *work) {
+    save_if_changed();
+}
+
+int keystroke_stats_save_now(void) {
     if (!state.initialized) {
-        return;
+        return -EAGAIN;
     }
 
-    /* Cancel any pending save and reschedule */
+    /* This save covers whatever the debounced one would have written */
     k_work_cancel_delayable(&state.save_work);
-    k_work_schedule(&state.save_work,
-                    K_MSEC(CONFIG_ZMK_KEYSTROKE_STATS_SAVE_DEBOUNCE_MS));
-    state.save_pending = true;
 
-    LOG_DBG("Save scheduled in %d ms", CONFIG_ZMK_KEYSTROKE_STATS_SAVE_DEBOUNCE_MS);
+    return save_if_changed();
 }
 
 /**
- * @brief Handle keystroke events
+ * @brief Schedule a save operation (with debounce)
+ *
+ * Further requests while a save is pending are folded into it rather than
+ * pushing it back, so continuous typing cannot postpone a save forever.
  */
-static int keystroke_event_listener(const zmk_event_t *eh) {
-    struct zmk_keycode_state_changed *ev = as_zmk_keycode_state_changed(eh);
-    if (ev == NULL) {
-        return ZMK_EV_EVENT_BUBBLE;
+static void schedule_save(void) {
+    if (!state.initialized) {
+        return;
     }
 
-    /* Only count key presses, not releases */
-    if (!ev->state) {
-        return ZMK_EV_EVENT_BUBBLE;
+    if (k_work_schedule_for_queue(&save_work_q, &state.save_work,
+                                  K_MSEC(CONFIG_ZMK_KEYSTROKE_STATS_SAVE_DEBOUNCE_MS)) > 0) {
+        state.save_pending = true;
+        LOG_DBG("Save scheduled in %d ms", CONFIG_ZMK_KEYSTROKE_STATS_SAVE_DEBOUNCE_MS);
     }
+}
 
-    k_mutex_lock(&stats_mutex, K_FOREVER);
-
+/**
+ * @brief Count one keystroke
+ *
+ * Called with stats_mutex held, once the persisted statistics are loaded.
+ *
+ * @param position Key position, or UINT32_MAX if unknown
+ */
+static void record_keystroke(uint32_t position) {
     /* Update counts */
     state.total_keystrokes++;
     state.today_keystrokes++;
+    mark_dirty(BIT(KEYSTROKE_STATS_SECTION_CORE));
+
+    state.unsaved_keystrokes++;
+#if CONFIG_ZMK_KEYSTROKE_STATS_SAVE_MAX_UNSAVED_KEYSTROKES > 0
+    if (state.unsaved_keystrokes >= CONFIG_ZMK_KEYSTROKE_STATS_SAVE_MAX_UNSAVED_KEYSTROKES) {
+        schedule_save();
+    }
+#endif
 
 #if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_SESSION_TRACKING
     check_session_timeout();
@@ -307,9 +522,10 @@ static int keystroke_event_listener(const zmk_event_t *eh) {
 
 #if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_KEY_HEATMAP
     /* Update key heatmap */
-    uint32_t position = ev->usage_page;  /* TODO: Use actual key position */
     if (position < CONFIG_ZMK_KEYSTROKE_STATS_MAX_KEY_POSITIONS) {
         state.key_counts[position]++;
+        mark_dirty(BIT(KEYSTROKE_STATS_SECTION_HEATMAP));
+        keystroke_stats_journal_note_key(position);
     }
 #endif
 
@@ -319,12 +535,62 @@ static int keystroke_event_listener(const zmk_event_t *eh) {
 
     /* Check for day rollover */
     check_day_rollover();
+}
+
+/*
+ * Keystrokes that arrive before the persisted statistics are loaded. They
+ * are counted once loading finishes, so they end up on top of the stored
+ * values instead of being overwritten by them. Beyond the buffer only the
+ * count is kept.
+ */
+static struct {
+    uint16_t positions[CONFIG_ZMK_KEYSTROKE_STATS_BOOT_KEY_BUFFER];
+    uint16_t count;
+} boot_keys;
+
+/**
+ * @brief Handle keystroke events
+ */
+static int keystroke_event_listener(const zmk_event_t *eh) {
+    struct zmk_position_state_changed *ev = as_zmk_position_state_changed(eh);
+    if (ev == NULL) {
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+
+    /* Only count key presses, not releases */
+    if (!ev->state) {
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+
+    /* The physical key, whatever the active layer maps it to */
+    uint32_t position = ev->position;
+
+    k_mutex_lock(&stats_mutex, K_FOREVER);
+
+    if (!state.initialized) {
+        if (boot_keys.count == 0) {
+            LOG_INF("First keystroke at %lld ms, statistics still loading", k_uptime_get());
+        }
+        if (boot_keys.count < ARRAY_SIZE(boot_keys.positions)) {
+            boot_keys.positions[boot_keys.count] = MIN(position, UINT16_MAX);
+        }
+        boot_keys.count = MIN(boot_keys.count + 1, UINT16_MAX);
+
+        k_mutex_unlock(&stats_mutex);
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+
+    record_keystroke(position);
 
     /* Notify callbacks */
-    notify_callbacks();
+    notify_callbacks(ZMK_KEYSTROKE_STATS_CHANGED_TODAY | ZMK_KEYSTROKE_STATS_CHANGED_TOTAL |
+                     ZMK_KEYSTROKE_STATS_CHANGED_SESSION | ZMK_KEYSTROKE_STATS_CHANGED_WPM |
+                     ZMK_KEYSTROKE_STATS_CHANGED_KEYS);
 
     k_mutex_unlock(&stats_mutex);
 
+    dispatch();
+
     LOG_DBG("Keystroke recorded: total=%u, today=%u",
             state.total_keystrokes, state.today_keystrokes);
 
@@ -332,59 +598,173 @@ static int keystroke_event_listener(const zmk_event_t *eh) {
 }
 
 ZMK_LISTENER(keystroke_stats, keystroke_event_listener);
-ZMK_SUBSCRIPTION(keystroke_stats, zmk_keycode_state_changed);
+ZMK_SUBSCRIPTION(keystroke_stats, zmk_position_state_changed);
 
-/* Periodic save timer */
-static void periodic_save_handler(struct k_timer *timer) {
-    LOG_INF("Periodic save triggered");
-    schedule_save();
-}
+/*
+ * keystroke_stats_changed event
+ *
+ * Raised on the system work queue once the statistics changed enough since
+ * the last event: CONFIG_ZMK_KEYSTROKE_STATS_EVENT_KEYSTROKE_DELTA
+ * keystrokes, a day rollover or a reset. Events are at least
+ * CONFIG_ZMK_KEYSTROKE_STATS_EVENT_MIN_INTERVAL_MS apart, changes within
+ * the interval are folded into the next one. Changes below the delta are
+ * raised when the keyboard goes idle, so listeners do not keep stale values
+ * while nothing is typed.
+ */
+
+/* Payload of the last raised event, the base for the next change mask */
+static struct zmk_keystroke_stats_changed last_event;
+static int64_t last_event_ms;
+static bool event_raised;
+
+static uint8_t changed_fields(const struct zmk_keystroke_stats_changed *ev) {
+    uint8_t changed = 0;
+
+    if (!event_raised) {
+        return ZMK_KEYSTROKE_STATS_CHANGED_ALL;
+    }
 
-K_TIMER_DEFINE(periodic_save_timer, periodic_save_handler, NULL);
+    if (ev->today_keystrokes != last_event.today_keystrokes) {
+        changed |= ZMK_KEYSTROKE_STATS_CHANGED_TODAY;
+    }
+    if (ev->yesterday_keystrokes != last_event.yesterday_keystrokes) {
+        changed |= ZMK_KEYSTROKE_STATS_CHANGED_YESTERDAY;
+    }
+    if (ev->total_keystrokes != last_event.total_keystrokes) {
+        changed |= ZMK_KEYSTROKE_STATS_CHANGED_TOTAL;
+    }
+    if (ev->session_keystrokes != last_event.session_keystrokes) {
+        changed |= ZMK_KEYSTROKE_STATS_CHANGED_SESSION;
+    }
+    if (ev->current_wpm != last_event.current_wpm || ev->peak_wpm != last_event.peak_wpm) {
+        changed |= ZMK_KEYSTROKE_STATS_CHANGED_WPM;
+    }
+    if (ev->day != last_event.day) {
+        changed |= ZMK_KEYSTROKE_STATS_CHANGED_DAY;
+    }
 
-/* UI update timer (60 second interval) */
-static void ui_update_work_handler(struct k_work *work) {
+    return changed;
+}
+
+static void changed_event_work_handler(struct k_work *work) {
     ARG_UNUSED(work);
 
-    /* Get current stats and raise event */
-    struct zmk_keystroke_stats stats;
-    if (zmk_keystroke_stats_get(&stats) == 0) {
-        LOG_INF("Raising keystroke_stats_changed event: today=%u, yesterday=%u, total=%u",
-                stats.today_keystrokes, stats.yesterday_keystrokes, stats.total_keystrokes);
-
-        raise_zmk_keystroke_stats_changed((struct zmk_keystroke_stats_changed){
-            .today_keystrokes = stats.today_keystrokes,
-            .yesterday_keystrokes = stats.yesterday_keystrokes,
-            .total_keystrokes = stats.total_keystrokes
-        });
-    } else {
-        LOG_WRN("Failed to get keystroke stats for UI update");
+    struct zmk_keystroke_stats_changed ev = {0};
+
+    k_mutex_lock(&stats_mutex, K_FOREVER);
+
+    ev.total_keystrokes = state.total_keystrokes;
+    ev.today_keystrokes = state.today_keystrokes;
+    ev.yesterday_keystrokes = state.yesterday_keystrokes;
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_SESSION_TRACKING
+    ev.session_keystrokes = state.session_keystrokes;
+#endif
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_WPM
+    ev.current_wpm = state.current_wpm;
+    ev.peak_wpm = state.peak_wpm;
+#endif
+    ev.day = state.current_uptime_day;
+    ev.changed = changed_fields(&ev);
+
+    if (ev.changed != 0) {
+        last_event = ev;
+        last_event_ms = k_uptime_get();
+        event_raised = true;
     }
+
+    k_mutex_unlock(&stats_mutex);
+
+    if (ev.changed == 0) {
+        return;
+    }
+
+    LOG_DBG("Raising keystroke_stats_changed event: changed=0x%02x today=%u, total=%u",
+            ev.changed, ev.today_keystrokes, ev.total_keystrokes);
+
+    raise_zmk_keystroke_stats_changed(ev);
 }
 
-K_WORK_DEFINE(ui_update_work, ui_update_work_handler);
+K_WORK_DELAYABLE_DEFINE(changed_event_work, changed_event_work_handler);
 
-static void ui_update_timer_handler(struct k_timer *timer) {
-    ARG_UNUSED(timer);
-    LOG_INF("UI update timer triggered");
+/**
+ * @brief Schedule a keystroke_stats_changed event if the change is significant
+ *
+ * @param force Raise any change, however small
+ */
+static void request_changed_event(bool force) {
+    k_mutex_lock(&stats_mutex, K_FOREVER);
+
+    if (!state.initialized) {
+        k_mutex_unlock(&stats_mutex);
+        return;
+    }
+
+    /* A reset lowers the counts, which also makes the unsigned delta large */
+    bool significant = force || !event_raised ||
+                       state.total_keystrokes - last_event.total_keystrokes >=
+                           CONFIG_ZMK_KEYSTROKE_STATS_EVENT_KEYSTROKE_DELTA ||
+                       state.today_keystrokes < last_event.today_keystrokes ||
+                       state.current_uptime_day != last_event.day;
+    int64_t wait_ms =
+        last_event_ms + CONFIG_ZMK_KEYSTROKE_STATS_EVENT_MIN_INTERVAL_MS - k_uptime_get();
+
+    k_mutex_unlock(&stats_mutex);
 
-    /* Submit to system work queue to raise event */
-    k_work_submit(&ui_update_work);
+    if (significant) {
+        /* Does nothing if already pending, so bursts fold into one event */
+        k_work_schedule(&changed_event_work, K_MSEC(MAX(wait_ms, 0)));
+    }
 }
 
-K_TIMER_DEFINE(ui_update_timer, ui_update_timer_handler, NULL);
+void keystroke_stats_set_active(bool active) {
+    if (!active) {
+        request_changed_event(true);
+    }
+}
 
 /**
  * @brief Public API Implementation
  */
 
-int zmk_keystroke_stats_get(struct zmk_keystroke_stats *stats) {
-    if (stats == NULL) {
-        return -EINVAL;
-    }
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_KEY_HEATMAP
+/**
+ * @brief Find the top N keys
+ *
+ * Inserts into the (short) output list directly, rather than sorting a copy
+ * of every key on the stack. Ties keep the lower position first.
+ */
+static void fill_top_keys(struct zmk_keystroke_stats *stats) {
+    int top_count = 0;
 
-    k_mutex_lock(&stats_mutex, K_FOREVER);
+    for (int pos = 0; pos < CONFIG_ZMK_KEYSTROKE_STATS_MAX_KEY_POSITIONS; pos++) {
+        uint32_t count = state.key_counts[pos];
+        int i = top_count;
 
+        if (top_count == CONFIG_ZMK_KEYSTROKE_STATS_TOP_KEYS_COUNT) {
+            if (count <= stats->top_keys[top_count - 1].count) {
+                continue;
+            }
+            i--;
+        } else {
+            top_count++;
+        }
+
+        for (; i > 0 && stats->top_keys[i - 1].count < count; i--) {
+            stats->top_keys[i] = stats->top_keys[i - 1];
+        }
+        stats->top_keys[i].position = pos;
+        stats->top_keys[i].count = count;
+    }
+}
+#endif
+
+/**
+ * @brief Copy the statistics into a snapshot
+ *
+ * Called with stats_mutex held. Top keys and history are only filled if
+ * fields include KEYS or HISTORY, the rest is always filled.
+ */
+static void fill_snapshot(struct zmk_keystroke_stats *stats, uint8_t fields) {
     memset(stats, 0, sizeof(*stats));
 
     stats->total_keystrokes = state.total_keystrokes;
@@ -406,43 +786,32 @@ int zmk_keystroke_stats_get(struct zmk_keystroke_stats *stats) {
 #endif
 
 #if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_KEY_HEATMAP
-    /* Find top N keys */
-    struct {
-        uint32_t position;
-        uint32_t count;
-    } top_keys[CONFIG_ZMK_KEYSTROKE_STATS_MAX_KEY_POSITIONS];
-
-    /* Copy all keys */
-    for (int i = 0; i < CONFIG_ZMK_KEYSTROKE_STATS_MAX_KEY_POSITIONS; i++) {
-        top_keys[i].position = i;
-        top_keys[i].count = state.key_counts[i];
-    }
-
-    /* Simple bubble sort to find top N */
-    for (int i = 0; i < CONFIG_ZMK_KEYSTROKE_STATS_TOP_KEYS_COUNT; i++) {
-        for (int j = i + 1; j < CONFIG_ZMK_KEYSTROKE_STATS_MAX_KEY_POSITIONS; j++) {
-            if (top_keys[j].count > top_keys[i].count) {
-                /* Swap */
-                uint32_t temp_pos = top_keys[i].position;
-                uint32_t temp_count = top_keys[i].count;
-                top_keys[i].position = top_keys[j].position;
-                top_keys[i].count = top_keys[j].count;
-                top_keys[j].position = temp_pos;
-                top_keys[j].count = temp_count;
-            }
-        }
-        stats->top_keys[i].position = top_keys[i].position;
-        stats->top_keys[i].count = top_keys[i].count;
+    if (fields & ZMK_KEYSTROKE_STATS_CHANGED_KEYS) {
+        fill_top_keys(stats);
     }
 #endif
 
 #if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_DAILY_HISTORY
-    stats->daily_stats_count = state.daily_history_count;
-    for (int i = 0; i < state.daily_history_count; i++) {
-        stats->daily_stats[i] = state.daily_history[i];
+    if (fields & ZMK_KEYSTROKE_STATS_CHANGED_HISTORY) {
+        stats->daily_stats_count = state.daily_history_count;
+        for (int i = 0; i < state.daily_history_count; i++) {
+            stats->daily_stats[i] = state.daily_history[i];
+        }
     }
 #endif
+}
+
+int zmk_keystroke_stats_get(struct zmk_keystroke_stats *stats) {
+    if (stats == NULL) {
+        return -EINVAL;
+    }
 
+    if (!state.initialized) {
+        return -EAGAIN;
+    }
+
+    k_mutex_lock(&stats_mutex, K_FOREVER);
+    fill_snapshot(stats, ZMK_KEYSTROKE_STATS_CHANGED_ALL);
     k_mutex_unlock(&stats_mutex);
 
     return 0;
@@ -458,6 +827,10 @@ int zmk_keystroke_stats_get_key_count(uint32_t position, uint32_t *count) {
         return -EINVAL;
     }
 
+    if (!state.initialized) {
+        return -EAGAIN;
+    }
+
     k_mutex_lock(&stats_mutex, K_FOREVER);
     *count = state.key_counts[position];
     k_mutex_unlock(&stats_mutex);
@@ -473,7 +846,26 @@ int zmk_keystroke_stats_save(void) {
     return 0;
 }
 
+int zmk_keystroke_stats_get_flash_telemetry(struct zmk_keystroke_stats_flash_telemetry *telemetry) {
+    if (telemetry == NULL) {
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&stats_mutex, K_FOREVER);
+    *telemetry = state.flash;
+    telemetry->since_last_save_ms =
+        state.last_save_ms < 0 ? UINT32_MAX
+                               : (uint32_t)MIN(k_uptime_get() - state.last_save_ms, UINT32_MAX);
+    k_mutex_unlock(&stats_mutex);
+
+    return 0;
+}
+
 int zmk_keystroke_stats_reset(bool reset_total) {
+    if (!state.initialized) {
+        return -EAGAIN;
+    }
+
     k_mutex_lock(&stats_mutex, K_FOREVER);
 
     LOG_WRN("Resetting statistics (reset_total=%d)", reset_total);
@@ -507,181 +899,277 @@ int zmk_keystroke_stats_reset(bool reset_total) {
     memset(state.daily_history, 0, sizeof(state.daily_history));
 #endif
 
+    state.reset_epoch++;
+
+    mark_dirty(KEYSTROKE_STATS_SECTIONS_ALL);
+    keystroke_stats_journal_invalidate();
+    note_changes(ZMK_KEYSTROKE_STATS_CHANGED_ALL);
+
     k_mutex_unlock(&stats_mutex);
 
     schedule_save();
-    notify_callbacks();
+    /* Raised even if only fields the keystroke delta ignores changed */
+    request_changed_event(true);
+    dispatch();
 
     return 0;
 }
 
-int zmk_keystroke_stats_register_callback(zmk_keystroke_stats_callback_t callback,
-                                           void *user_data) {
-    if (callback == NULL) {
+int zmk_keystroke_stats_subscribe(struct zmk_keystroke_stats_subscriber *subscriber) {
+    if (subscriber == NULL || subscriber->callback == NULL) {
         return -EINVAL;
     }
 
+    k_mutex_lock(&notify_mutex, K_FOREVER);
     k_mutex_lock(&stats_mutex, K_FOREVER);
 
-    if (state.callback_count >= ARRAY_SIZE(state.callbacks)) {
-        k_mutex_unlock(&stats_mutex);
-        return -ENOMEM;
+    bool found = sys_slist_find(&state.subscribers, &subscriber->node, NULL);
+    if (!found) {
+        subscriber->pending = 0;
+        subscriber->notifying = false;
+        /* The first change is not held back */
+        subscriber->last_notify_ms = k_uptime_get() - subscriber->min_interval_ms;
+        sys_slist_append(&state.subscribers, &subscriber->node);
     }
 
-    state.callbacks[state.callback_count].callback = callback;
-    state.callbacks[state.callback_count].user_data = user_data;
-    state.callback_count++;
+    k_mutex_unlock(&stats_mutex);
+    k_mutex_unlock(&notify_mutex);
+
+    if (found) {
+        return -EALREADY;
+    }
 
+    LOG_INF("Subscriber added (interest 0x%02x, min interval %u ms)", subscriber->interest,
+            subscriber->min_interval_ms);
+
+    return 0;
+}
+
+int zmk_keystroke_stats_unsubscribe(struct zmk_keystroke_stats_subscriber *subscriber) {
+    if (subscriber == NULL) {
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&notify_mutex, K_FOREVER);
+    k_mutex_lock(&stats_mutex, K_FOREVER);
+    bool found = sys_slist_find_and_remove(&state.subscribers, &subscriber->node);
     k_mutex_unlock(&stats_mutex);
+    k_mutex_unlock(&notify_mutex);
+
+    if (!found) {
+        return -ENOENT;
+    }
 
-    LOG_INF("Callback registered (%d total)", state.callback_count);
+    LOG_INF("Subscriber removed");
 
     return 0;
 }
 
+/* Subscribers behind the callback API, free while callback is NULL */
+static struct zmk_keystroke_stats_subscriber
+    callback_subscribers[CONFIG_ZMK_KEYSTROKE_STATS_MAX_CALLBACKS];
+
+int zmk_keystroke_stats_register_callback(zmk_keystroke_stats_callback_t callback,
+                                           void *user_data) {
+    if (callback == NULL) {
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&notify_mutex, K_FOREVER);
+
+    for (size_t i = 0; i < ARRAY_SIZE(callback_subscribers); i++) {
+        struct zmk_keystroke_stats_subscriber *sub = &callback_subscribers[i];
+
+        if (sub->callback == NULL) {
+            *sub = (struct zmk_keystroke_stats_subscriber){
+                .callback = callback,
+                .user_data = user_data,
+            };
+            int ret = zmk_keystroke_stats_subscribe(sub);
+
+            k_mutex_unlock(&notify_mutex);
+            return ret;
+        }
+    }
+
+    k_mutex_unlock(&notify_mutex);
+
+    return -ENOMEM;
+}
+
 int zmk_keystroke_stats_unregister_callback(zmk_keystroke_stats_callback_t callback) {
-    k_mutex_lock(&stats_mutex, K_FOREVER);
+    k_mutex_lock(&notify_mutex, K_FOREVER);
 
-    for (int i = 0; i < state.callback_count; i++) {
-        if (state.callbacks[i].callback == callback) {
-            /* Shift remaining callbacks */
-            for (int j = i; j < state.callback_count - 1; j++) {
-                state.callbacks[j] = state.callbacks[j + 1];
-            }
-            state.callback_count--;
-            k_mutex_unlock(&stats_mutex);
-            LOG_INF("Callback unregistered");
+    for (size_t i = 0; i < ARRAY_SIZE(callback_subscribers); i++) {
+        struct zmk_keystroke_stats_subscriber *sub = &callback_subscribers[i];
+
+        if (sub->callback != NULL && sub->callback == callback) {
+            zmk_keystroke_stats_unsubscribe(sub);
+            sub->callback = NULL;
+            k_mutex_unlock(&notify_mutex);
             return 0;
         }
     }
 
-    k_mutex_unlock(&stats_mutex);
+    k_mutex_unlock(&notify_mutex);
     return -ENOENT;
 }
 
 /**
- * @brief Module initialization
+ * @brief Move the stored day onto the wall-clock day
+ *
+ * Called with stats_mutex held.
  */
-static int keystroke_stats_init(void) {
-    LOG_INF("Initializing keystroke statistics module");
-
-    /* Initialize state */
-    memset(&state, 0, sizeof(state));
-    state.current_uptime_day = get_uptime_day();
-
-    /* Initialize delayed work for save */
-    k_work_init_delayable(&state.save_work, save_work_handler);
+static void sync_day(uint16_t day) {
+    if (keystroke_stats_day_is_calendar(state.current_uptime_day) &&
+        day > state.current_uptime_day) {
+        /* Real days have passed since the stored day (e.g. powered off overnight) */
+        apply_day_rollover(day);
+    } else if (day != state.current_uptime_day) {
+        /* First sync, or host clock moved backwards: relabel today without a rollover */
+        LOG_INF("Day relabelled: %u -> %u", state.current_uptime_day, day);
+        state.current_uptime_day = day;
+        mark_dirty(BIT(KEYSTROKE_STATS_SECTION_CORE));
+    }
+}
 
-    /* Load persisted data */
-    extern int keystroke_stats_load_from_settings(void);
-    int ret = keystroke_stats_load_from_settings();
-    if (ret != 0) {
-        LOG_WRN("Failed to load persisted statistics: %d (starting fresh)", ret);
+int zmk_keystroke_stats_set_time(int64_t epoch_s, int16_t utc_offset_min) {
+    if (epoch_s < 0 || utc_offset_min < -720 || utc_offset_min > 840) {
+        return -EINVAL;
     }
 
-    /* Start periodic save timer */
-    k_timer_start(&periodic_save_timer,
-                  K_MSEC(CONFIG_ZMK_KEYSTROKE_STATS_SAVE_INTERVAL_MS),
-                  K_MSEC(CONFIG_ZMK_KEYSTROKE_STATS_SAVE_INTERVAL_MS));
+    k_mutex_lock(&stats_mutex, K_FOREVER);
 
-    /* Start UI update timer (60 second interval) */
-    k_timer_start(&ui_update_timer, K_SECONDS(60), K_SECONDS(60));
+    uint16_t day = keystroke_stats_time_set(epoch_s, utc_offset_min);
 
-    state.initialized = true;
+    /* Before loading finishes the stored day is not known yet; loading syncs it */
+    if (state.initialized) {
+        sync_day(day);
+    }
 
-    LOG_INF("Keystroke statistics module initialized");
-    LOG_INF("  Save interval: %d ms (%d hours)",
-            CONFIG_ZMK_KEYSTROKE_STATS_SAVE_INTERVAL_MS,
-            CONFIG_ZMK_KEYSTROKE_STATS_SAVE_INTERVAL_MS / 3600000);
-    LOG_INF("  UI update interval: 60 seconds");
-    LOG_INF("  Current uptime day: %u", state.current_uptime_day);
+    k_mutex_unlock(&stats_mutex);
+
+    /* Subscribers of a rollover */
+    dispatch();
 
     return 0;
 }
 
-SYS_INIT(keystroke_stats_init, APPLICATION, 50);
+int zmk_keystroke_stats_get_time(int64_t *epoch_s) {
+    if (epoch_s == NULL) {
+        return -EINVAL;
+    }
 
-/* Persistence API implementation */
+    k_mutex_lock(&stats_mutex, K_FOREVER);
+    int ret = keystroke_stats_time_get_epoch(epoch_s);
+    k_mutex_unlock(&stats_mutex);
 
-#define PERSIST_DATA_VERSION 1
+    return ret;
+}
 
-int zmk_keystroke_stats_get_persist_data(struct zmk_keystroke_stats_persist_data *data) {
-    if (!data) {
-        return -EINVAL;
+/**
+ * @brief Load persisted statistics and start counting
+ *
+ * Keystrokes buffered while this ran are counted afterwards.
+ */
+static void load_persisted(void) {
+    int64_t start = k_uptime_get();
+
+    int ret = keystroke_stats_load_from_settings();
+    if (ret != 0) {
+        LOG_WRN("Failed to load persisted statistics: %d (starting fresh)", ret);
     }
 
     k_mutex_lock(&stats_mutex, K_FOREVER);
 
-    /* Populate persistent data structure */
-    data->version = PERSIST_DATA_VERSION;
-    data->total_keystrokes = state.total_keystrokes;
-    data->today_keystrokes = state.today_keystrokes;
-    data->yesterday_keystrokes = state.yesterday_keystrokes;
-    data->current_uptime_day = state.current_uptime_day;
+    /* Changes a warm reset cut off before they were saved */
+    keystroke_stats_retained_restore();
 
-#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_WPM
-    data->peak_wpm = state.peak_wpm;
-    data->total_typing_time_ms = state.total_typing_time_ms;
-#endif
+    /* Data loaded in an older format, replayed from the journal or recovered still needs writing */
+    bool unsaved = state.dirty_sections != 0;
+    if (unsaved) {
+        mark_dirty(0);
+    }
 
-#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_KEY_HEATMAP
-    memcpy(data->key_counts, state.key_counts, sizeof(data->key_counts));
-#endif
+    state.initialized = true;
 
-#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_DAILY_HISTORY
-    memcpy(data->daily_history, state.daily_history, sizeof(data->daily_history));
-    data->daily_history_count = state.daily_history_count;
-#endif
+    /* The host may have set the time while loading */
+    if (keystroke_stats_time_is_synced()) {
+        sync_day(keystroke_stats_time_get_day(k_uptime_get()));
+    }
 
-    k_mutex_unlock(&stats_mutex);
+    for (uint16_t i = 0; i < boot_keys.count; i++) {
+        record_keystroke(i < ARRAY_SIZE(boot_keys.positions) ? boot_keys.positions[i]
+                                                            : UINT32_MAX);
+    }
+    uint16_t buffered = boot_keys.count;
+    boot_keys.count = 0;
 
-    LOG_DBG("Persist data retrieved: version=%d, total=%u, today=%u",
-            data->version, data->total_keystrokes, data->today_keystrokes);
+    /* Listeners get the loaded values without waiting for a keystroke */
+    notify_callbacks(ZMK_KEYSTROKE_STATS_CHANGED_ALL);
 
-    return 0;
-}
+    k_mutex_unlock(&stats_mutex);
 
-int zmk_keystroke_stats_load_persist_data(const struct zmk_keystroke_stats_persist_data *data) {
-    if (!data) {
-        return -EINVAL;
-    }
+    LOG_INF("Statistics loaded in %lld ms, %u keystrokes arrived while loading",
+            k_uptime_get() - start, buffered);
 
-    /* Validate data version */
-    if (data->version != PERSIST_DATA_VERSION) {
-        LOG_WRN("Incompatible persist data version: %d (expected %d)",
-                data->version, PERSIST_DATA_VERSION);
-        return -EINVAL;
+    /* Write it soon rather than when the max unsaved age runs out */
+    if (unsaved) {
+        schedule_save();
     }
 
-    k_mutex_lock(&stats_mutex, K_FOREVER);
+    dispatch();
+}
 
-    /* Restore persistent fields */
-    state.total_keystrokes = data->total_keystrokes;
-    state.today_keystrokes = data->today_keystrokes;
-    state.yesterday_keystrokes = data->yesterday_keystrokes;
-    state.current_uptime_day = data->current_uptime_day;
+#if CONFIG_ZMK_KEYSTROKE_STATS_DEFERRED_LOAD
+static void load_work_handler(struct k_work *work) {
+    load_persisted();
+}
 
-#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_WPM
-    state.peak_wpm = data->peak_wpm;
-    state.total_typing_time_ms = data->total_typing_time_ms;
+K_WORK_DEFINE(load_work, load_work_handler);
 #endif
 
-#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_KEY_HEATMAP
-    memcpy(state.key_counts, data->key_counts, sizeof(state.key_counts));
-#endif
+/**
+ * @brief Module initialization
+ */
+static int keystroke_stats_init(void) {
+    uint32_t init_start = k_cycle_get_32();
 
-#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_DAILY_HISTORY
-    memcpy(state.daily_history, data->daily_history, sizeof(state.daily_history));
-    state.daily_history_count = data->daily_history_count;
-#endif
+    LOG_INF("Initializing keystroke statistics module");
 
-    k_mutex_unlock(&stats_mutex);
+    /* Initialize state */
+    memset(&state, 0, sizeof(state));
+    state.last_save_ms = -1;
+    state.current_uptime_day = keystroke_stats_time_get_day(k_uptime_get());
 
-    LOG_INF("Persist data loaded: total=%u, today=%u, yesterday=%u",
-            state.total_keystrokes, state.today_keystrokes, state.yesterday_keystrokes);
+    /* Initialize delayed work for save and the queue it runs on */
+    k_work_init_delayable(&state.save_work, save_work_handler);
+    k_work_queue_init(&save_work_q);
+    k_work_queue_start(&save_work_q, save_work_q_stack,
+                       K_THREAD_STACK_SIZEOF(save_work_q_stack),
+                       CONFIG_ZMK_KEYSTROKE_STATS_SAVE_THREAD_PRIORITY,
+                       &(struct k_work_queue_config){.name = "kstats_save"});
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_DEFERRED_LOAD
+    /* Flash reads and decoding happen after boot, at the save queue's low priority */
+    k_work_submit_to_queue(&save_work_q, &load_work);
+#else
+    load_persisted();
+#endif
 
-    /* Notify callbacks about loaded data */
-    notify_callbacks();
+    LOG_INF("Keystroke statistics module initialized in %u us",
+            k_cyc_to_us_floor32(k_cycle_get_32() - init_start));
+    LOG_INF("  Max unsaved age: %d ms (%d hours), max unsaved keystrokes: %d",
+            CONFIG_ZMK_KEYSTROKE_STATS_SAVE_INTERVAL_MS,
+            CONFIG_ZMK_KEYSTROKE_STATS_SAVE_INTERVAL_MS / 3600000,
+            CONFIG_ZMK_KEYSTROKE_STATS_SAVE_MAX_UNSAVED_KEYSTROKES);
+    LOG_INF("  Changed event: every %d keystrokes, at most every %d ms",
+            CONFIG_ZMK_KEYSTROKE_STATS_EVENT_KEYSTROKE_DELTA,
+            CONFIG_ZMK_KEYSTROKE_STATS_EVENT_MIN_INTERVAL_MS);
+    LOG_INF("  Current day: %u (%s)", state.current_uptime_day,
+            keystroke_stats_day_is_calendar(state.current_uptime_day) ? "calendar" : "uptime");
 
     return 0;
 }
+
+SYS_INIT(keystroke_stats_init, APPLICATION, 50);
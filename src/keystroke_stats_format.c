@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zmk/keystroke_stats.h>
+
+/*
+ * Count formatting shared by the UIs. Every label refresh goes through
+ * here, so it avoids snprintf: no format string parsing, no libc
+ * formatting code pulled in for a UI that otherwise needs none, and a
+ * small fixed stack.
+ *
+ * Digits are written backwards two at a time from a table of all pairs,
+ * so a 4-digit value takes two divisions by 100.
+ */
+
+static const char digit_pairs[200] = "00010203040506070809"
+                                     "10111213141516171819"
+                                     "20212223242526272829"
+                                     "30313233343536373839"
+                                     "40414243444546474849"
+                                     "50515253545556575859"
+                                     "60616263646566676869"
+                                     "70717273747576777879"
+                                     "80818283848586878889"
+                                     "90919293949596979899";
+
+/**
+ * @brief Write value backwards ending at end
+ *
+ * @return First character written
+ */
+static char *put_uint(char *end, uint32_t value) {
+    while (value >= 100) {
+        const char *pair = &digit_pairs[(value % 100) * 2];
+
+        value /= 100;
+        *--end = pair[1];
+        *--end = pair[0];
+    }
+
+    if (value >= 10) {
+        *--end = digit_pairs[value * 2 + 1];
+        *--end = digit_pairs[value * 2];
+    } else {
+        *--end = '0' + value;
+    }
+
+    return end;
+}
+
+size_t zmk_keystroke_stats_format_count(uint32_t value, char *buf, size_t size) {
+    char tmp[ZMK_KEYSTROKE_STATS_COUNT_STR_LEN - 1];
+    char *end = tmp + sizeof(tmp);
+    char *text;
+
+    if (value < 10000) {
+        text = put_uint(end, value);
+    } else {
+        uint32_t unit = 1000;
+        char suffix = 'K';
+
+        if (value >= 1000000000) {
+            unit = 1000000000;
+            suffix = 'G';
+        } else if (value >= 1000000) {
+            unit = 1000000;
+            suffix = 'M';
+        }
+
+        /* Truncated, not rounded, so "999.9K" never turns into "1000K" */
+        uint32_t whole = value / unit;
+        uint32_t tenths = (value % unit) / (unit / 10);
+
+        text = end;
+        *--text = suffix;
+        if (tenths != 0) {
+            *--text = '0' + tenths;
+            *--text = '.';
+        }
+        text = put_uint(text, whole);
+    }
+
+    size_t len = end - text;
+    if (len >= size) {
+        if (size > 0) {
+            buf[0] = '\0';
+        }
+        return 0;
+    }
+
+    memcpy(buf, text, len);
+    buf[len] = '\0';
+
+    return len;
+}
+
+size_t zmk_keystroke_stats_format_count_padded(uint32_t value, char *buf, size_t size,
+                                               size_t width) {
+    char text[ZMK_KEYSTROKE_STATS_COUNT_STR_LEN];
+    size_t len = zmk_keystroke_stats_format_count(value, text, sizeof(text));
+    size_t pad = width > len ? width - len : 0;
+
+    if (pad + len >= size) {
+        if (size > 0) {
+            buf[0] = '\0';
+        }
+        return 0;
+    }
+
+    memset(buf, ' ', pad);
+    memcpy(buf + pad, text, len + 1);
+
+    return pad + len;
+}
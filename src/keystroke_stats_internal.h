@@ -0,0 +1,386 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zephyr/kernel.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <zmk/keystroke_stats.h>
+
+/**
+ * @file keystroke_stats_internal.h
+ * @brief Private interfaces shared between the core statistics sources
+ *
+ * Nothing in here is part of the public API. UI implementations must only
+ * use include/zmk/keystroke_stats.h.
+ */
+
+/* Statistics engine (keystroke_stats.c) */
+
+/**
+ * @brief Independently persisted parts of the engine state
+ *
+ * Each section is stored under its own settings key and only rewritten when
+ * its dirty bit is set. New sections are appended at the end.
+ */
+enum keystroke_stats_section {
+    /* total/today/yesterday/day */
+    KEYSTROKE_STATS_SECTION_CORE,
+    /* peak WPM, typing time */
+    KEYSTROKE_STATS_SECTION_WPM,
+    /* per-key counts */
+    KEYSTROKE_STATS_SECTION_HEATMAP,
+    /* daily history */
+    KEYSTROKE_STATS_SECTION_HISTORY,
+
+    KEYSTROKE_STATS_SECTION_COUNT,
+};
+
+#define KEYSTROKE_STATS_SECTIONS_ALL (BIT(KEYSTROKE_STATS_SECTION_COUNT) - 1)
+
+/**
+ * @brief Internal engine state
+ *
+ * Owned by keystroke_stats.c. Persistence code may access it through
+ * keystroke_stats_state_get() while holding stats_mutex.
+ */
+struct keystroke_stats_state {
+    /* Core statistics */
+    uint32_t total_keystrokes;
+    uint32_t today_keystrokes;
+    uint32_t yesterday_keystrokes;
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_SESSION_TRACKING
+    uint32_t session_keystrokes;
+    uint32_t session_start_time;
+#endif
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_WPM
+    uint8_t current_wpm;
+    uint8_t average_wpm;
+    uint8_t peak_wpm;
+    uint32_t total_typing_time_ms;
+
+    /* WPM calculation window */
+    struct {
+        uint32_t keystrokes[10];  /* Ring buffer of keystroke counts */
+        uint32_t timestamps[10];  /* Corresponding timestamps */
+        uint8_t head;             /* Next write position */
+        uint8_t count;            /* Number of valid entries */
+    } wpm_window;
+#endif
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_KEY_HEATMAP
+    uint32_t key_counts[CONFIG_ZMK_KEYSTROKE_STATS_MAX_KEY_POSITIONS];
+#endif
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_DAILY_HISTORY
+    struct zmk_keystroke_stats_daily_entry daily_history[CONFIG_ZMK_KEYSTROKE_STATS_DAILY_HISTORY_DAYS];
+    uint8_t daily_history_count;
+#endif
+
+    /* Day tracking (calendar day once time is set, uptime-based otherwise) */
+    uint16_t current_uptime_day;
+    uint32_t last_keystroke_time;
+
+    /* Bumped by every reset, orders copies whose counts are not comparable */
+    uint32_t reset_epoch;
+
+    /* struct zmk_keystroke_stats_subscriber, in subscription order */
+    sys_slist_t subscribers;
+
+    /* Save management */
+    uint8_t dirty_sections;  /* BIT(enum keystroke_stats_section) changed since saved */
+    uint32_t change_seq;           /* Bumped on every change */
+    uint32_t saved_seq;            /* change_seq covered by the last successful save */
+    int64_t unsaved_since_ms;      /* Uptime of the oldest unsaved change */
+    uint32_t unsaved_keystrokes;   /* Keystrokes since the last successful save */
+    uint32_t save_count;           /* Successful saves since boot */
+    int64_t last_save_ms;          /* Uptime of the last successful save, -1 if none */
+    /* Lifetime flash accounting, persisted in the core section */
+    struct zmk_keystroke_stats_flash_telemetry flash;
+    struct k_work_delayable save_work;
+    bool save_pending;
+    bool initialized;
+};
+
+extern struct k_mutex stats_mutex;
+
+struct keystroke_stats_state *keystroke_stats_state_get(void);
+
+/**
+ * @brief Save scheduler state, for diagnostics
+ */
+struct keystroke_stats_save_status {
+    /* Keystrokes a power loss right now would lose */
+    uint32_t unsaved_keystrokes;
+    /* Age of the oldest unsaved change, 0 if everything is saved */
+    uint32_t unsaved_age_ms;
+    /* Successful saves since boot */
+    uint32_t save_count;
+    /* Flash lifespan at the save rate measured since boot, 0 before the first save */
+    uint32_t projected_lifespan_days;
+};
+
+void keystroke_stats_save_status_get(struct keystroke_stats_save_status *status);
+
+/**
+ * @brief Save unsaved changes immediately, bypassing the debounce
+ *
+ * Blocks until written. For moments when waiting is not an option (the
+ * keyboard is about to power off). Must not be called with stats_mutex held.
+ *
+ * @return 0 if saved or nothing to save, negative errno on failure
+ */
+int keystroke_stats_save_now(void);
+
+/**
+ * @brief Track ZMK activity changes
+ *
+ * Going idle raises a keystroke_stats_changed event for changes still below
+ * the event's keystroke delta.
+ *
+ * @param active false when the keyboard goes idle or to sleep
+ */
+void keystroke_stats_set_active(bool active);
+
+/**
+ * @brief Insert a finished day into daily history
+ *
+ * Keeps entries ordered by day, replaces an existing entry for the same day
+ * and drops the oldest entry when full. No-op without daily history.
+ */
+void keystroke_stats_history_insert(uint16_t day, uint32_t keystrokes);
+
+/* Settings layer (keystroke_stats_settings.c) */
+
+int keystroke_stats_save_to_settings(void);
+int keystroke_stats_load_from_settings(void);
+
+/* Legacy storage migration (keystroke_stats_migrate.c) */
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_KEY_HEATMAP
+#define KEYSTROKE_STATS_LEGACY_KEYS CONFIG_ZMK_KEYSTROKE_STATS_MAX_KEY_POSITIONS
+#else
+#define KEYSTROKE_STATS_LEGACY_KEYS 0
+#endif
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_DAILY_HISTORY
+/* Top of the Kconfig range, so a longer old history still fits */
+#define KEYSTROKE_STATS_LEGACY_DAYS 30
+#else
+#define KEYSTROKE_STATS_LEGACY_DAYS 0
+#endif
+
+/**
+ * @brief Largest legacy "data" record written with this build's configuration
+ *
+ * Header and counters (15), WPM (5), key counts, 8-byte history entries and
+ * the history count. Records from builds with more key positions are
+ * larger; only their counters can be recovered.
+ */
+#define KEYSTROKE_STATS_LEGACY_DATA_MAX_BYTES                                                      \
+    (15 + 5 + 4 * KEYSTROKE_STATS_LEGACY_KEYS + 8 * KEYSTROKE_STATS_LEGACY_DAYS + 1)
+
+/**
+ * @brief Load the single-record format used before sectioned storage
+ *
+ * Counters are always recovered. WPM, heatmap and history are recovered if
+ * the record size matches this build's features, allowing for a changed key
+ * count or history length. Marks all sections dirty so the next save writes
+ * the current format. Called with stats_mutex held.
+ *
+ * @param data Record contents
+ * @param len Bytes available in data
+ * @param stored_len Size of the stored record (larger than len if truncated)
+ * @return 0 on success, -ENOTSUP for an unknown version, -EINVAL if too short
+ */
+int keystroke_stats_migrate_legacy(const uint8_t *data, size_t len, size_t stored_len);
+
+/* Direct flash backend (keystroke_stats_store.c)
+ *
+ * Records in a dedicated NVS or ZMS partition, addressed by numeric ID.
+ * Missing records read as -ENOENT.
+ */
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_STORAGE_DIRECT
+
+int keystroke_stats_store_init(void);
+int keystroke_stats_store_write(uint16_t id, const void *data, size_t len);
+
+/**
+ * @brief Read the start of a record
+ *
+ * @return Bytes read (at most len), negative errno on failure
+ */
+ssize_t keystroke_stats_store_read(uint16_t id, void *data, size_t len);
+
+/**
+ * @brief Stored length of a record
+ */
+ssize_t keystroke_stats_store_length(uint16_t id);
+
+#endif /* CONFIG_ZMK_KEYSTROKE_STATS_STORAGE_DIRECT */
+
+/* Retained RAM copy (keystroke_stats_retained.c) */
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_RETAINED
+
+/**
+ * @brief Persisted state changed, refresh the retained copy soon
+ *
+ * Called with stats_mutex held.
+ */
+void keystroke_stats_retained_changed(void);
+
+/**
+ * @brief Apply a retained copy that is newer than the loaded state
+ *
+ * Called after loading from settings, with stats_mutex held. Marks all
+ * sections dirty if anything was recovered.
+ *
+ * @return true if the retained copy was applied
+ */
+bool keystroke_stats_retained_restore(void);
+
+#else
+
+static inline void keystroke_stats_retained_changed(void) {}
+static inline bool keystroke_stats_retained_restore(void) { return false; }
+
+#endif /* CONFIG_ZMK_KEYSTROKE_STATS_RETAINED */
+
+/* Time anchor (keystroke_stats_time.c)
+ *
+ * All functions below expect the caller to hold stats_mutex.
+ */
+
+static inline bool keystroke_stats_day_is_calendar(uint16_t day) {
+    return day >= ZMK_KEYSTROKE_STATS_CALENDAR_DAY_MIN;
+}
+
+/**
+ * @brief Get the current day number
+ *
+ * Returns days since 1970-01-01 (local time) once the host has provided the
+ * time, otherwise an uptime-relative counter continuing from the last
+ * persisted day. Only does a compare against a cached boundary on the fast
+ * path.
+ */
+uint16_t keystroke_stats_time_get_day(int64_t now_ms);
+
+/**
+ * @brief Continue uptime-relative day counting from a persisted day number
+ *
+ * Called after persisted data is loaded so that a reboot does not look like
+ * a day change. Ignored once wall-clock time is known.
+ */
+void keystroke_stats_time_rebase(uint16_t day);
+
+/**
+ * @brief Anchor the day computation to wall-clock time
+ *
+ * @return The current (local) calendar day number
+ */
+uint16_t keystroke_stats_time_set(int64_t epoch_s, int16_t utc_offset_min);
+
+bool keystroke_stats_time_is_synced(void);
+
+int keystroke_stats_time_get_epoch(int64_t *epoch_s);
+
+/* Journal (keystroke_stats_journal.c)
+ *
+ * Small delta records appended between full checkpoints. A checkpoint
+ * writes every dirty section with a new generation number, core last.
+ * Records carry the generation they build on, and on load each record's
+ * per-section changes are only applied to sections that were not already
+ * rewritten by a newer (possibly interrupted) checkpoint.
+ *
+ * The note_*, invalidate, checkpoint_begin, section_saved and *_loaded
+ * hooks are called with stats_mutex held; the rest lock it themselves.
+ */
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_JOURNAL
+
+void keystroke_stats_journal_note_key(uint32_t position);
+void keystroke_stats_journal_note_history(uint16_t day, uint32_t keystrokes);
+
+/**
+ * @brief Force the next save to write a full checkpoint
+ *
+ * Used for changes a delta record cannot express (e.g. reset).
+ */
+void keystroke_stats_journal_invalidate(void);
+
+/**
+ * @brief Start a new checkpoint generation
+ *
+ * @return Generation to store with every section of the checkpoint
+ */
+uint16_t keystroke_stats_journal_checkpoint_begin(void);
+
+/**
+ * @brief A section was snapshotted for writing
+ *
+ * Clears the pending deltas that the snapshot now contains. Must be called
+ * under the same lock as the snapshot.
+ */
+void keystroke_stats_journal_section_saved(enum keystroke_stats_section section);
+
+/**
+ * @brief Report the outcome of writing the checkpoint started last
+ */
+void keystroke_stats_journal_checkpoint_done(int result);
+
+/**
+ * @brief Record the generation a section was loaded with
+ *
+ * Loading the core section sets the generation journal records must match.
+ */
+void keystroke_stats_journal_section_loaded(enum keystroke_stats_section section, uint16_t gen);
+
+/**
+ * @brief Encode pending deltas into a journal record
+ *
+ * @param buf Output buffer
+ * @param size Size of buf
+ * @param seq Pointer to store the record sequence number (slot)
+ * @return Record length, 0 if nothing changed, -ENOSPC if a checkpoint is
+ *         needed instead
+ */
+int keystroke_stats_journal_build(uint8_t *buf, size_t size, uint8_t *seq);
+
+/**
+ * @brief Report the outcome of writing the last built record
+ */
+void keystroke_stats_journal_record_done(int result);
+
+/**
+ * @brief Apply one stored record on top of the loaded sections
+ *
+ * Records of the current generation may be applied in any order.
+ */
+int keystroke_stats_journal_replay(const uint8_t *buf, size_t len);
+
+/**
+ * @brief Finish replay after all stored records were applied
+ */
+void keystroke_stats_journal_replay_done(void);
+
+#else
+
+static inline void keystroke_stats_journal_note_key(uint32_t position) {}
+static inline void keystroke_stats_journal_note_history(uint16_t day, uint32_t keystrokes) {}
+static inline void keystroke_stats_journal_invalidate(void) {}
+static inline uint16_t keystroke_stats_journal_checkpoint_begin(void) { return 0; }
+static inline void
+keystroke_stats_journal_section_saved(enum keystroke_stats_section section) {}
+static inline void keystroke_stats_journal_checkpoint_done(int result) {}
+static inline void
+keystroke_stats_journal_section_loaded(enum keystroke_stats_section section, uint16_t gen) {}
+
+#endif /* CONFIG_ZMK_KEYSTROKE_STATS_JOURNAL */
@@ -0,0 +1,441 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+#include "keystroke_stats_internal.h"
+#include "keystroke_stats_varint.h"
+
+LOG_MODULE_REGISTER(keystroke_stats_journal, CONFIG_ZMK_KEYSTROKE_STATS_LOG_LEVEL);
+
+/**
+ * @brief Append-only journal between full checkpoints
+ *
+ * Instead of rewriting every dirty section on each save, a save appends a
+ * small record with what changed since the previous one. Every
+ * CONFIG_ZMK_KEYSTROKE_STATS_JOURNAL_MAX_RECORDS records (or whenever a change
+ * cannot be expressed as a delta) a full checkpoint is written instead and a
+ * new generation starts. Records of older generations are simply ignored and
+ * their slots get overwritten, so nothing ever needs to be deleted.
+ *
+ * Record layout (all numbers LEB128 varints unless noted):
+ *
+ *   u8 version, u16 generation (LE), u8 sequence
+ *   total keystroke delta
+ *   day, today, yesterday, peak WPM          (absolute, latest record wins)
+ *   history entry count, then per entry: day, keystrokes
+ *   key count, then per changed key: position gap, count delta
+ *
+ * Deltas commute, history inserts are idempotent and the absolute fields are
+ * resolved by sequence number, so records can be replayed in whatever order
+ * the settings backend returns them.
+ */
+
+#define JOURNAL_RECORD_VERSION 2
+#define JOURNAL_HEADER_LEN 4
+#define JOURNAL_MAX_HISTORY 2
+
+BUILD_ASSERT(CONFIG_ZMK_KEYSTROKE_STATS_JOURNAL_MAX_RECORDS <= UINT8_MAX,
+             "Journal sequence numbers are 8-bit");
+
+static struct {
+    /* Generation of the checkpoint the journal is based on */
+    uint16_t gen;
+    /* Sequence number of the next record */
+    uint8_t next_seq;
+    /* Next save must be a checkpoint */
+    bool checkpoint_needed;
+    /* Checkpoint started but not completely written yet */
+    bool checkpoint_in_flight;
+
+    /* Values at the last write, to detect and compute changes */
+    uint32_t saved_total;
+    uint16_t saved_day;
+
+    /* History entries added since the last write */
+    uint8_t history_count;
+    struct {
+        uint16_t day;
+        uint32_t keystrokes;
+    } history[JOURNAL_MAX_HISTORY];
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_KEY_HEATMAP
+    /* Per-key presses since the last write */
+    uint16_t key_delta[CONFIG_ZMK_KEYSTROKE_STATS_MAX_KEY_POSITIONS];
+#endif
+
+    /* Generation each section was loaded with */
+    uint16_t section_gen[KEYSTROKE_STATS_SECTION_COUNT];
+
+    /* Replay bookkeeping: newest record seen */
+    int16_t replay_latest_seq;
+} journal = {
+    /* Nothing to base records on until core has been loaded or written */
+    .checkpoint_needed = true,
+    .replay_latest_seq = -1,
+};
+
+void keystroke_stats_journal_note_key(uint32_t position) {
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_KEY_HEATMAP
+    if (position >= CONFIG_ZMK_KEYSTROKE_STATS_MAX_KEY_POSITIONS) {
+        return;
+    }
+
+    if (journal.key_delta[position] == UINT16_MAX) {
+        journal.checkpoint_needed = true;
+        return;
+    }
+
+    journal.key_delta[position]++;
+#endif
+}
+
+void keystroke_stats_journal_note_history(uint16_t day, uint32_t keystrokes) {
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_DAILY_HISTORY
+    if (journal.history_count >= JOURNAL_MAX_HISTORY) {
+        journal.checkpoint_needed = true;
+        return;
+    }
+
+    journal.history[journal.history_count].day = day;
+    journal.history[journal.history_count].keystrokes = keystrokes;
+    journal.history_count++;
+#endif
+}
+
+void keystroke_stats_journal_invalidate(void) {
+    journal.checkpoint_needed = true;
+}
+
+uint16_t keystroke_stats_journal_checkpoint_begin(void) {
+    journal.gen++;
+    journal.next_seq = 0;
+    journal.checkpoint_needed = false;
+    journal.checkpoint_in_flight = true;
+
+    return journal.gen;
+}
+
+void keystroke_stats_journal_section_saved(enum keystroke_stats_section section) {
+    struct keystroke_stats_state *s = keystroke_stats_state_get();
+
+    switch (section) {
+    case KEYSTROKE_STATS_SECTION_CORE:
+        journal.saved_total = s->total_keystrokes;
+        journal.saved_day = s->current_uptime_day;
+        break;
+    case KEYSTROKE_STATS_SECTION_HEATMAP:
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_KEY_HEATMAP
+        memset(journal.key_delta, 0, sizeof(journal.key_delta));
+#endif
+        break;
+    case KEYSTROKE_STATS_SECTION_HISTORY:
+        journal.history_count = 0;
+        break;
+    default:
+        break;
+    }
+}
+
+void keystroke_stats_journal_checkpoint_done(int result) {
+    k_mutex_lock(&stats_mutex, K_FOREVER);
+
+    journal.checkpoint_in_flight = false;
+    if (result < 0) {
+        journal.checkpoint_needed = true;
+    }
+
+    k_mutex_unlock(&stats_mutex);
+}
+
+void keystroke_stats_journal_section_loaded(enum keystroke_stats_section section, uint16_t gen) {
+    journal.section_gen[section] = gen;
+
+    if (section == KEYSTROKE_STATS_SECTION_CORE) {
+        /* Records replayed on top count as changes since this save */
+        keystroke_stats_journal_section_saved(section);
+        journal.gen = gen;
+        journal.next_seq = 0;
+        journal.checkpoint_needed = false;
+        journal.replay_latest_seq = -1;
+    }
+}
+
+/**
+ * @brief Whether a section was rewritten by a checkpoint newer than core
+ *
+ * Happens when power is lost during a checkpoint after some sections but
+ * before core were written. Such a section already contains the changes of
+ * the current journal records.
+ */
+static bool section_is_newer(enum keystroke_stats_section section) {
+    return (int16_t)(journal.section_gen[section] - journal.gen) > 0;
+}
+
+static void clear_pending(void) {
+    for (int i = 0; i < KEYSTROKE_STATS_SECTION_COUNT; i++) {
+        keystroke_stats_journal_section_saved(i);
+    }
+}
+
+/* Bounded writer, fails once the record would exceed the buffer */
+struct record_writer {
+    uint8_t *buf;
+    size_t size;
+    size_t len;
+    bool overflow;
+};
+
+static void put_varint(struct record_writer *w, uint32_t value) {
+    size_t n = w->overflow ? 0 : varint_encode(value, w->buf + w->len, w->size - w->len);
+
+    if (n == 0) {
+        w->overflow = true;
+    }
+    w->len += n;
+}
+
+int keystroke_stats_journal_build(uint8_t *buf, size_t size, uint8_t *seq) {
+    struct keystroke_stats_state *s = keystroke_stats_state_get();
+    int ret;
+
+    k_mutex_lock(&stats_mutex, K_FOREVER);
+
+    if (journal.checkpoint_needed || journal.checkpoint_in_flight ||
+        journal.next_seq >= CONFIG_ZMK_KEYSTROKE_STATS_JOURNAL_MAX_RECORDS) {
+        ret = -ENOSPC;
+        goto out;
+    }
+
+    uint32_t total_delta = s->total_keystrokes - journal.saved_total;
+    if (total_delta == 0 && journal.history_count == 0 &&
+        journal.saved_day == s->current_uptime_day) {
+        ret = 0;
+        goto out;
+    }
+
+    if (size < JOURNAL_HEADER_LEN) {
+        ret = -ENOSPC;
+        goto out;
+    }
+
+    struct record_writer w = {.buf = buf, .size = size, .len = JOURNAL_HEADER_LEN};
+
+    buf[0] = JOURNAL_RECORD_VERSION;
+    buf[1] = (uint8_t)journal.gen;
+    buf[2] = (uint8_t)(journal.gen >> 8);
+    buf[3] = journal.next_seq;
+
+    put_varint(&w, total_delta);
+    put_varint(&w, s->current_uptime_day);
+    put_varint(&w, s->today_keystrokes);
+    put_varint(&w, s->yesterday_keystrokes);
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_WPM
+    put_varint(&w, s->peak_wpm);
+#else
+    put_varint(&w, 0);
+#endif
+
+    put_varint(&w, journal.history_count);
+    for (int i = 0; i < journal.history_count; i++) {
+        put_varint(&w, journal.history[i].day);
+        put_varint(&w, journal.history[i].keystrokes);
+    }
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_KEY_HEATMAP
+    uint32_t key_count = 0;
+    for (int i = 0; i < CONFIG_ZMK_KEYSTROKE_STATS_MAX_KEY_POSITIONS; i++) {
+        key_count += journal.key_delta[i] != 0;
+    }
+
+    put_varint(&w, key_count);
+    uint32_t prev = 0;
+    for (int i = 0; i < CONFIG_ZMK_KEYSTROKE_STATS_MAX_KEY_POSITIONS; i++) {
+        if (journal.key_delta[i] != 0) {
+            put_varint(&w, i - prev);
+            put_varint(&w, journal.key_delta[i]);
+            prev = i;
+        }
+    }
+#else
+    put_varint(&w, 0);
+#endif
+
+    if (w.overflow) {
+        /* Too much changed for a small record, compact instead */
+        ret = -ENOSPC;
+        goto out;
+    }
+
+    /* Deltas are now owned by the record; a failed write forces a checkpoint */
+    *seq = journal.next_seq;
+    clear_pending();
+    ret = w.len;
+
+out:
+    k_mutex_unlock(&stats_mutex);
+    return ret;
+}
+
+void keystroke_stats_journal_record_done(int result) {
+    k_mutex_lock(&stats_mutex, K_FOREVER);
+
+    if (result < 0) {
+        journal.checkpoint_needed = true;
+    } else {
+        journal.next_seq++;
+    }
+
+    k_mutex_unlock(&stats_mutex);
+}
+
+/**
+ * @brief Walk a record, optionally applying it to the engine state
+ *
+ * Run once without applying to validate the whole record, so a corrupt
+ * record is never half-applied.
+ */
+static int parse_record(const uint8_t *buf, size_t len, bool apply) {
+    struct keystroke_stats_state *s = keystroke_stats_state_get();
+    uint8_t seq = buf[3];
+    size_t pos = JOURNAL_HEADER_LEN;
+    uint32_t v[5];
+
+#define GET(out)                                                                                   \
+    do {                                                                                           \
+        size_t n = varint_decode(buf + pos, len - pos, &(out));                                    \
+        if (n == 0) {                                                                              \
+            return -EINVAL;                                                                        \
+        }                                                                                          \
+        pos += n;                                                                                  \
+    } while (0)
+
+    /* total delta, day, today, yesterday, peak WPM */
+    for (size_t i = 0; i < ARRAY_SIZE(v); i++) {
+        GET(v[i]);
+    }
+
+    if (apply) {
+        s->total_keystrokes += v[0];
+        if (seq >= journal.replay_latest_seq) {
+            s->current_uptime_day = (uint16_t)v[1];
+            s->today_keystrokes = v[2];
+            s->yesterday_keystrokes = v[3];
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_WPM
+            s->peak_wpm = (uint8_t)MIN(v[4], UINT8_MAX);
+#endif
+            journal.replay_latest_seq = seq;
+        }
+        s->dirty_sections |= BIT(KEYSTROKE_STATS_SECTION_CORE) | BIT(KEYSTROKE_STATS_SECTION_WPM);
+    }
+
+    uint32_t history_count;
+    GET(history_count);
+    for (uint32_t i = 0; i < history_count; i++) {
+        GET(v[0]);
+        GET(v[1]);
+
+        if (apply && !section_is_newer(KEYSTROKE_STATS_SECTION_HISTORY)) {
+            keystroke_stats_history_insert((uint16_t)v[0], v[1]);
+            s->dirty_sections |= BIT(KEYSTROKE_STATS_SECTION_HISTORY);
+        }
+    }
+
+    uint32_t key_count;
+    uint32_t position = 0;
+    GET(key_count);
+    for (uint32_t i = 0; i < key_count; i++) {
+        GET(v[0]);
+        GET(v[1]);
+        position += v[0];
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_KEY_HEATMAP
+        if (apply && position < CONFIG_ZMK_KEYSTROKE_STATS_MAX_KEY_POSITIONS &&
+            !section_is_newer(KEYSTROKE_STATS_SECTION_HEATMAP)) {
+            s->key_counts[position] += v[1];
+            s->dirty_sections |= BIT(KEYSTROKE_STATS_SECTION_HEATMAP);
+        }
+#endif
+    }
+
+#undef GET
+
+    if (apply) {
+        journal.next_seq = MAX(journal.next_seq, seq + 1);
+    }
+
+    return 0;
+}
+
+int keystroke_stats_journal_replay(const uint8_t *buf, size_t len) {
+    if (len < JOURNAL_HEADER_LEN || buf[0] != JOURNAL_RECORD_VERSION) {
+        return -EINVAL;
+    }
+
+    uint16_t gen = buf[1] | (buf[2] << 8);
+
+    k_mutex_lock(&stats_mutex, K_FOREVER);
+
+    int ret;
+    if (journal.checkpoint_needed || gen != journal.gen) {
+        /* Left over from an older checkpoint */
+        ret = -ESTALE;
+    } else {
+        ret = parse_record(buf, len, false);
+        if (ret == 0) {
+            parse_record(buf, len, true);
+            LOG_DBG("Replayed journal record gen=%u seq=%u", gen, buf[3]);
+        }
+    }
+
+    k_mutex_unlock(&stats_mutex);
+
+    return ret;
+}
+
+void keystroke_stats_journal_replay_done(void) {
+    struct keystroke_stats_state *s = keystroke_stats_state_get();
+
+    k_mutex_lock(&stats_mutex, K_FOREVER);
+
+    if (journal.replay_latest_seq >= 0) {
+        LOG_INF("Journal replayed: %u records on top of checkpoint gen %u",
+                journal.next_seq, journal.gen);
+        keystroke_stats_time_rebase(s->current_uptime_day);
+    }
+
+    /*
+     * After an interrupted checkpoint, records on top of core would have their
+     * deltas skipped by the newer sections on the next boot as well. Start a
+     * new generation past the newest section instead of reusing its number.
+     */
+    uint16_t newest = journal.gen;
+    for (int i = 0; i < KEYSTROKE_STATS_SECTION_COUNT; i++) {
+        if (section_is_newer(i) && (int16_t)(journal.section_gen[i] - newest) > 0) {
+            newest = journal.section_gen[i];
+        }
+    }
+    if (newest != journal.gen) {
+        LOG_WRN("Checkpoint gen %u was interrupted, starting a new one", newest);
+        journal.gen = newest;
+        keystroke_stats_journal_invalidate();
+    }
+
+    /*
+     * Replayed deltas stay pending against the loaded sections, and the
+     * post-load save folds them into a checkpoint: a record repeating them
+     * would be replayed on top of the ones it repeats.
+     */
+    if (journal.replay_latest_seq >= 0) {
+        keystroke_stats_journal_invalidate();
+    } else {
+        clear_pending();
+    }
+
+    k_mutex_unlock(&stats_mutex);
+}
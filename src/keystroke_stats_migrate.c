@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "keystroke_stats_internal.h"
+
+LOG_MODULE_REGISTER(keystroke_stats_migrate, CONFIG_ZMK_KEYSTROKE_STATS_LOG_LEVEL);
+
+/*
+ * Before sectioned storage everything was one packed record under
+ * "keystroke_stats/data", version 1 being the only one released:
+ *
+ *   u8  version
+ *   u32 total, u32 today, u32 yesterday, u16 day
+ *   u8  peak WPM, u32 typing time                (if WPM was enabled)
+ *   u32 key_counts[MAX_KEY_POSITIONS]            (if heatmap was enabled)
+ *   entry daily_history[DAILY_HISTORY_DAYS]      (if history was enabled)
+ *   u8  daily_history_count
+ *
+ * History entries were {u16 year, u8 month, u8 day, u32 count}, with year
+ * and month left zero and day being the low byte of the uptime day.
+ *
+ * The record size depended on the Kconfig of the firmware that wrote it.
+ * The fields up to the day are always at the same offsets, so those are
+ * migrated unconditionally. The rest is only migrated if the size can be
+ * explained by this build's features with either the key count or the
+ * history length changed.
+ */
+
+#define LEGACY_CORE_BYTES (1 + 3 * sizeof(uint32_t) + sizeof(uint16_t))
+#define LEGACY_WPM_BYTES (1 + sizeof(uint32_t))
+#define LEGACY_VERSION 1
+#define LEGACY_ENTRY_BYTES 8
+
+/* Kconfig ranges of the old settings */
+#define LEGACY_KEYS_MIN 10
+#define LEGACY_KEYS_MAX 256
+#define LEGACY_DAYS_MIN 1
+#define LEGACY_DAYS_MAX 30
+
+struct legacy_layout {
+    size_t wpm;        /* offset of the WPM fields, 0 if absent */
+    size_t keys;       /* offset of the key counts */
+    size_t num_keys;
+    size_t history;    /* offset of the history entries */
+    size_t num_days;
+};
+
+static uint16_t get_le16(const uint8_t *p) {
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t get_le32(const uint8_t *p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief Check that the history part of a candidate layout looks sane
+ *
+ * Used entries must have year and month zero and a non-zero count (a day
+ * was only rolled over by a keystroke, after counting it), unused ones must
+ * be all zero. This rejects most wrong guesses about which optional parts
+ * were present.
+ */
+static bool history_valid(const struct legacy_layout *l, const uint8_t *data, size_t len) {
+    uint8_t count = data[len - 1];
+
+    if (count > l->num_days) {
+        return false;
+    }
+
+    for (size_t i = 0; i < l->num_days; i++) {
+        const uint8_t *entry = &data[l->history + i * LEGACY_ENTRY_BYTES];
+        size_t zero_bytes = i < count ? 3 : LEGACY_ENTRY_BYTES;
+
+        for (size_t j = 0; j < zero_bytes; j++) {
+            if (entry[j] != 0) {
+                return false;
+            }
+        }
+
+        if (i < count && get_le32(&entry[4]) == 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Split the bytes after the WPM fields into heatmap and history
+ *
+ * @param offset Offset of the first byte after the WPM fields
+ */
+static bool fit_tail(struct legacy_layout *l, const uint8_t *data, size_t len, size_t offset) {
+    const bool heatmap = IS_ENABLED(CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_KEY_HEATMAP);
+    const bool history = IS_ENABLED(CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_DAILY_HISTORY);
+    size_t rest = len - offset;
+
+    l->keys = offset;
+    l->num_keys = 0;
+    l->num_days = 0;
+
+    if (!heatmap && !history) {
+        return rest == 0;
+    }
+
+    if (heatmap && !history) {
+        l->num_keys = rest / sizeof(uint32_t);
+        return rest % sizeof(uint32_t) == 0 &&
+               IN_RANGE(l->num_keys, LEGACY_KEYS_MIN, LEGACY_KEYS_MAX);
+    }
+
+    if (rest < 1) {
+        return false;
+    }
+    rest -= 1;
+
+    if (!heatmap) {
+        l->num_days = rest / LEGACY_ENTRY_BYTES;
+        l->history = offset;
+        return rest % LEGACY_ENTRY_BYTES == 0 &&
+               IN_RANGE(l->num_days, LEGACY_DAYS_MIN, LEGACY_DAYS_MAX) &&
+               history_valid(l, data, len);
+    }
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_KEY_HEATMAP && CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_DAILY_HISTORY
+    /* Same key count, history length possibly changed */
+    size_t keys_bytes = CONFIG_ZMK_KEYSTROKE_STATS_MAX_KEY_POSITIONS * sizeof(uint32_t);
+    if (rest >= keys_bytes && (rest - keys_bytes) % LEGACY_ENTRY_BYTES == 0) {
+        l->num_keys = CONFIG_ZMK_KEYSTROKE_STATS_MAX_KEY_POSITIONS;
+        l->num_days = (rest - keys_bytes) / LEGACY_ENTRY_BYTES;
+        l->history = offset + keys_bytes;
+        if (IN_RANGE(l->num_days, LEGACY_DAYS_MIN, LEGACY_DAYS_MAX) &&
+            history_valid(l, data, len)) {
+            return true;
+        }
+    }
+
+    /* Same history length, key count possibly changed */
+    size_t days_bytes = CONFIG_ZMK_KEYSTROKE_STATS_DAILY_HISTORY_DAYS * LEGACY_ENTRY_BYTES;
+    if (rest >= days_bytes && (rest - days_bytes) % sizeof(uint32_t) == 0) {
+        l->num_days = CONFIG_ZMK_KEYSTROKE_STATS_DAILY_HISTORY_DAYS;
+        l->num_keys = (rest - days_bytes) / sizeof(uint32_t);
+        l->history = offset + l->num_keys * sizeof(uint32_t);
+        if (IN_RANGE(l->num_keys, LEGACY_KEYS_MIN, LEGACY_KEYS_MAX) &&
+            history_valid(l, data, len)) {
+            return true;
+        }
+    }
+#endif
+
+    return false;
+}
+
+/**
+ * @brief Work out where the optional parts of a legacy record are
+ *
+ * Tries this build's WPM setting first, then the opposite one, since WPM
+ * is the only optional part whose absence cannot be inferred from sizes.
+ */
+static bool fit_layout(struct legacy_layout *l, const uint8_t *data, size_t len) {
+    size_t offset = LEGACY_CORE_BYTES;
+    bool wpm = IS_ENABLED(CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_WPM);
+
+    for (int attempt = 0; attempt < 2; attempt++, wpm = !wpm) {
+        size_t tail = offset + (wpm ? LEGACY_WPM_BYTES : 0);
+
+        l->wpm = wpm ? offset : 0;
+        if (len >= tail && fit_tail(l, data, len, tail)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void migrate_tail(struct keystroke_stats_state *s, const struct legacy_layout *l,
+                         const uint8_t *data, size_t len) {
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_WPM
+    if (l->wpm != 0) {
+        s->peak_wpm = data[l->wpm];
+        s->total_typing_time_ms = get_le32(&data[l->wpm + 1]);
+    }
+#endif
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_KEY_HEATMAP
+    for (size_t i = 0; i < MIN(l->num_keys, ARRAY_SIZE(s->key_counts)); i++) {
+        s->key_counts[i] = get_le32(&data[l->keys + i * sizeof(uint32_t)]);
+    }
+#endif
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_DAILY_HISTORY
+    uint8_t count = data[len - 1];
+
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t *entry = &data[l->history + i * LEGACY_ENTRY_BYTES];
+
+        /* Only the low byte of the uptime day was kept; take the latest match */
+        uint16_t day = s->current_uptime_day - (uint8_t)(s->current_uptime_day - entry[3]);
+
+        keystroke_stats_history_insert(day, get_le32(&entry[4]));
+    }
+#endif
+}
+
+int keystroke_stats_migrate_legacy(const uint8_t *data, size_t len, size_t stored_len) {
+    struct keystroke_stats_state *s = keystroke_stats_state_get();
+
+    if (len < LEGACY_CORE_BYTES) {
+        return -EINVAL;
+    }
+
+    if (data[0] != LEGACY_VERSION) {
+        LOG_WRN("Legacy statistics version %u not supported", data[0]);
+        return -ENOTSUP;
+    }
+
+    s->total_keystrokes = get_le32(&data[1]);
+    s->today_keystrokes = get_le32(&data[5]);
+    s->yesterday_keystrokes = get_le32(&data[9]);
+    s->current_uptime_day = get_le16(&data[13]);
+
+    struct legacy_layout layout;
+    if (len == stored_len && fit_layout(&layout, data, len)) {
+        migrate_tail(s, &layout, data, len);
+        LOG_INF("Migrated legacy statistics (%zu bytes, %zu keys, %zu days)", stored_len,
+                layout.num_keys, layout.num_days);
+    } else {
+        LOG_WRN("Legacy statistics layout (%zu bytes) does not match this build, "
+                "only counters were migrated", stored_len);
+    }
+
+    keystroke_stats_time_rebase(s->current_uptime_day);
+
+    /* Write everything in the current format on the next save */
+    s->dirty_sections = KEYSTROKE_STATS_SECTIONS_ALL;
+    keystroke_stats_journal_invalidate();
+
+    return 0;
+}
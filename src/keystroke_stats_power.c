@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zmk/event_manager.h>
+
+#include <zmk/activity.h>
+#include <zmk/events/activity_state_changed.h>
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_SAVE_ON_LOW_BATTERY
+#include <zmk/events/battery_state_changed.h>
+#endif
+
+#include "keystroke_stats_internal.h"
+
+LOG_MODULE_REGISTER(keystroke_stats_power, CONFIG_ZMK_KEYSTROKE_STATS_LOG_LEVEL);
+
+/**
+ * @brief Save before power goes away
+ *
+ * ZMK raises the sleep event right before powering off, and listeners run
+ * synchronously, so the save happens here rather than through the debounced
+ * work item. Below the low-battery threshold every further percent lost
+ * triggers a save, so at most the last percent of use is at risk when the
+ * battery dies.
+ *
+ * Activity changes are also passed on to the core, which flushes pending
+ * change events when the keyboard goes idle.
+ */
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_SAVE_ON_LOW_BATTERY
+/* Lowest charge a save was made at, 101 until the threshold is crossed */
+static uint8_t low_battery_saved_soc = 101;
+#endif
+
+static void save_for(const char *reason) {
+    int ret = keystroke_stats_save_now();
+    if (ret == -EAGAIN) {
+        /* Keystrokes so far are buffered and counted once loading finishes */
+        LOG_WRN("Save on %s skipped, statistics still loading", reason);
+        return;
+    }
+    if (ret < 0) {
+        LOG_ERR("Save on %s failed: %d", reason, ret);
+        return;
+    }
+
+    LOG_DBG("Saved on %s", reason);
+}
+
+static int power_event_listener(const zmk_event_t *eh) {
+    const struct zmk_activity_state_changed *activity = as_zmk_activity_state_changed(eh);
+    if (activity != NULL) {
+        keystroke_stats_set_active(activity->state == ZMK_ACTIVITY_ACTIVE);
+
+        if (IS_ENABLED(CONFIG_ZMK_KEYSTROKE_STATS_SAVE_ON_SLEEP) &&
+            activity->state == ZMK_ACTIVITY_SLEEP) {
+            save_for("sleep");
+        } else if (IS_ENABLED(CONFIG_ZMK_KEYSTROKE_STATS_SAVE_ON_IDLE) &&
+                   activity->state == ZMK_ACTIVITY_IDLE) {
+            save_for("idle");
+        }
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_SAVE_ON_LOW_BATTERY
+    const struct zmk_battery_state_changed *battery = as_zmk_battery_state_changed(eh);
+    if (battery != NULL) {
+        uint8_t soc = battery->state_of_charge;
+
+        if (soc > CONFIG_ZMK_KEYSTROKE_STATS_LOW_BATTERY_PERCENT) {
+            /* Charged again: re-arm */
+            low_battery_saved_soc = 101;
+        } else if (soc < low_battery_saved_soc) {
+            low_battery_saved_soc = soc;
+            save_for("low battery");
+        }
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+#endif
+
+    return ZMK_EV_EVENT_BUBBLE;
+}
+
+ZMK_LISTENER(keystroke_stats_power, power_event_listener);
+ZMK_SUBSCRIPTION(keystroke_stats_power, zmk_activity_state_changed);
+#if CONFIG_ZMK_KEYSTROKE_STATS_SAVE_ON_LOW_BATTERY
+ZMK_SUBSCRIPTION(keystroke_stats_power, zmk_battery_state_changed);
+#endif
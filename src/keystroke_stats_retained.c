@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/crc.h>
+#include <string.h>
+
+#include "keystroke_stats_internal.h"
+
+LOG_MODULE_REGISTER(keystroke_stats_retained, CONFIG_ZMK_KEYSTROKE_STATS_LOG_LEVEL);
+
+/*
+ * Copy of the persisted statistics in a .noinit block, which survives warm
+ * resets (watchdog, fault, sys_reboot) but not power loss. It is refreshed
+ * at most every CONFIG_ZMK_KEYSTROKE_STATS_RETAINED_SYNC_MS after a change,
+ * so a reset loses at most that much typing instead of everything since the
+ * last save.
+ *
+ * On a cold boot, or if a bootloader reused the RAM, the CRC does not match
+ * and the block is ignored.
+ *
+ * Counts only grow between resets, so of two copies from the same reset
+ * epoch the one with the larger total is newer. Across a reset only the
+ * epoch tells them apart: a reset that reached the retained copy but not
+ * flash must not be undone by the older, larger counts in flash.
+ */
+
+#define RETAINED_MAGIC 0x6b737231 /* "ksr1" */
+
+struct retained_stats {
+    uint32_t reset_epoch;
+    uint32_t total_keystrokes;
+    uint32_t today_keystrokes;
+    uint32_t yesterday_keystrokes;
+    uint16_t current_uptime_day;
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_WPM
+    uint8_t peak_wpm;
+    uint32_t total_typing_time_ms;
+#endif
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_KEY_HEATMAP
+    uint32_t key_counts[CONFIG_ZMK_KEYSTROKE_STATS_MAX_KEY_POSITIONS];
+#endif
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_DAILY_HISTORY
+    struct zmk_keystroke_stats_daily_entry daily_history[CONFIG_ZMK_KEYSTROKE_STATS_DAILY_HISTORY_DAYS];
+    uint8_t daily_history_count;
+#endif
+};
+
+/* Features that change the meaning, not just the size, of the block */
+#define RETAINED_LAYOUT                                                                            \
+    ((uint32_t)sizeof(struct retained_stats) |                                                     \
+     (IS_ENABLED(CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_WPM) << 16) |                                   \
+     (IS_ENABLED(CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_KEY_HEATMAP) << 17) |                           \
+     (IS_ENABLED(CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_DAILY_HISTORY) << 18))
+
+struct retained_block {
+    uint32_t magic;
+    uint32_t layout;
+    struct retained_stats stats;
+    uint32_t crc; /* Over layout and stats */
+};
+
+static __noinit struct retained_block retained;
+
+static uint32_t retained_crc(void) {
+    return crc32_ieee((const uint8_t *)&retained.layout,
+                      offsetof(struct retained_block, crc) -
+                          offsetof(struct retained_block, layout));
+}
+
+static void retained_sync_handler(struct k_work *work) {
+    struct keystroke_stats_state *s = keystroke_stats_state_get();
+    struct retained_stats *r = &retained.stats;
+
+    k_mutex_lock(&stats_mutex, K_FOREVER);
+
+    /* A reset in the middle of the update leaves the block invalid, not torn */
+    retained.magic = 0;
+
+    r->reset_epoch = s->reset_epoch;
+    r->total_keystrokes = s->total_keystrokes;
+    r->today_keystrokes = s->today_keystrokes;
+    r->yesterday_keystrokes = s->yesterday_keystrokes;
+    r->current_uptime_day = s->current_uptime_day;
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_WPM
+    r->peak_wpm = s->peak_wpm;
+    r->total_typing_time_ms = s->total_typing_time_ms;
+#endif
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_KEY_HEATMAP
+    memcpy(r->key_counts, s->key_counts, sizeof(r->key_counts));
+#endif
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_DAILY_HISTORY
+    memcpy(r->daily_history, s->daily_history, sizeof(r->daily_history));
+    r->daily_history_count = s->daily_history_count;
+#endif
+
+    retained.layout = RETAINED_LAYOUT;
+    retained.crc = retained_crc();
+    retained.magic = RETAINED_MAGIC;
+
+    k_mutex_unlock(&stats_mutex);
+}
+
+static K_WORK_DELAYABLE_DEFINE(retained_sync_work, retained_sync_handler);
+
+void keystroke_stats_retained_changed(void) {
+    /* Does not push back a pending sync, so steady typing still syncs */
+    k_work_schedule(&retained_sync_work, K_MSEC(CONFIG_ZMK_KEYSTROKE_STATS_RETAINED_SYNC_MS));
+}
+
+/**
+ * @brief Whether the retained copy holds anything the loaded state lacks
+ */
+static bool retained_differs(const struct keystroke_stats_state *s) {
+    const struct retained_stats *r = &retained.stats;
+
+    if (r->reset_epoch != s->reset_epoch || r->total_keystrokes != s->total_keystrokes ||
+        r->today_keystrokes != s->today_keystrokes ||
+        r->yesterday_keystrokes != s->yesterday_keystrokes ||
+        r->current_uptime_day != s->current_uptime_day) {
+        return true;
+    }
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_WPM
+    if (r->peak_wpm != s->peak_wpm || r->total_typing_time_ms != s->total_typing_time_ms) {
+        return true;
+    }
+#endif
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_KEY_HEATMAP
+    if (memcmp(r->key_counts, s->key_counts, sizeof(r->key_counts)) != 0) {
+        return true;
+    }
+#endif
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_DAILY_HISTORY
+    if (r->daily_history_count != s->daily_history_count ||
+        memcmp(r->daily_history, s->daily_history, sizeof(r->daily_history)) != 0) {
+        return true;
+    }
+#endif
+
+    return false;
+}
+
+bool keystroke_stats_retained_restore(void) {
+    struct keystroke_stats_state *s = keystroke_stats_state_get();
+    const struct retained_stats *r = &retained.stats;
+
+    if (retained.magic != RETAINED_MAGIC || retained.layout != RETAINED_LAYOUT ||
+        retained.crc != retained_crc()) {
+        LOG_DBG("No retained statistics (cold boot)");
+        return false;
+    }
+
+    int32_t epochs = (int32_t)(r->reset_epoch - s->reset_epoch);
+    if (epochs < 0 || (epochs == 0 && r->total_keystrokes < s->total_keystrokes) ||
+        !retained_differs(s)) {
+        LOG_DBG("Retained statistics already saved");
+        return false;
+    }
+
+    if (epochs > 0) {
+        LOG_INF("Recovered an unsaved reset from retained RAM");
+    } else {
+        LOG_INF("Recovered %u unsaved keystrokes from retained RAM",
+                r->total_keystrokes - s->total_keystrokes);
+    }
+
+    s->reset_epoch = r->reset_epoch;
+    s->total_keystrokes = r->total_keystrokes;
+    s->today_keystrokes = r->today_keystrokes;
+    s->yesterday_keystrokes = r->yesterday_keystrokes;
+    s->current_uptime_day = r->current_uptime_day;
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_WPM
+    s->peak_wpm = r->peak_wpm;
+    s->total_typing_time_ms = r->total_typing_time_ms;
+#endif
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_KEY_HEATMAP
+    memcpy(s->key_counts, r->key_counts, sizeof(s->key_counts));
+#endif
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_DAILY_HISTORY
+    memcpy(s->daily_history, r->daily_history, sizeof(s->daily_history));
+    s->daily_history_count = MIN(r->daily_history_count, ARRAY_SIZE(s->daily_history));
+#endif
+
+    keystroke_stats_time_rebase(s->current_uptime_day);
+
+    /* The journal only knows about changes made since load: checkpoint instead */
+    s->dirty_sections = KEYSTROKE_STATS_SECTIONS_ALL;
+    keystroke_stats_journal_invalidate();
+
+    return true;
+}
@@ -8,79 +8,903 @@
 #include <zephyr/device.h>
 #include <zephyr/settings/settings.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/crc.h>
 #include <string.h>
 #include <zmk/keystroke_stats.h>
 
+#include "keystroke_stats_internal.h"
+#include "keystroke_stats_tlv.h"
+#include "keystroke_stats_varint.h"
+
 LOG_MODULE_REGISTER(keystroke_stats_settings, CONFIG_ZMK_KEYSTROKE_STATS_LOG_LEVEL);
 
 /* Settings key prefix */
 #define SETTINGS_KEY "keystroke_stats"
 
-/* Current data structure version */
-#define SETTINGS_VERSION 1
+/*
+ * Layout under SETTINGS_KEY:
+ *   core    - total/today/yesterday/day
+ *   wpm     - peak WPM, typing time
+ *   heatmap - per-key counts
+ *   history - daily history entries
+ *   <section>/b - second slot of each section
+ *   j/<n>   - journal records written after the last checkpoint (if enabled)
+ *   data    - single record used by older versions, migrated on load and
+ *             deleted once the first checkpoint is written
+ *
+ * Every section value starts with a small header (own version and the
+ * checkpoint generation it was written in) and is only rewritten when its
+ * dirty bit is set. A section that fails to load is skipped on its own
+ * instead of discarding everything.
+ *
+ * Sections alternate between two slots and end with a trailer holding a
+ * per-section sequence number and a CRC32. Loading keeps the newest copy
+ * that passes the CRC, so a write torn by power loss falls back to the
+ * previous copy instead of loading garbage. Values from before the trailer
+ * was added (no SECTION_FLAG_CRC) are accepted as sequence 0.
+ *
+ * With a direct backend (CONFIG_ZMK_KEYSTROKE_STATS_STORAGE_DIRECT) the
+ * same values are stored in a dedicated NVS/ZMS partition under numeric
+ * IDs instead (see RECORD_ID_*). Settings is then only read once, to move
+ * existing statistics over, and cleaned up after the first checkpoint.
+ */
+
+struct section_header {
+    uint8_t version;
+    uint8_t flags;
+    uint16_t gen;
+} __packed;
+
+/* The value ends with a struct section_trailer */
+#define SECTION_FLAG_CRC BIT(0)
+
+struct section_trailer {
+    uint16_t seq;
+    uint16_t reserved;
+    uint32_t crc; /* Over everything before it, header included */
+} __packed;
+
+#define SECTION_SLOTS 2
+
+/* Record IDs in the direct backend */
+#define RECORD_ID_SECTION(idx, slot) (0x10 + (idx) * SECTION_SLOTS + (slot))
+#define RECORD_ID_JOURNAL(seq) (0x100 + (seq))
+#define RECORD_ID_IS_SECTION(id) ((id) < RECORD_ID_JOURNAL(0))
+#define RECORD_ID_SECTION_IDX(id) (((id) - 0x10) / SECTION_SLOTS)
+#define RECORD_ID_SECTION_SLOT(id) (((id) - 0x10) % SECTION_SLOTS)
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_JOURNAL
+#define JOURNAL_RECORDS CONFIG_ZMK_KEYSTROKE_STATS_JOURNAL_MAX_RECORDS
+#else
+#define JOURNAL_RECORDS 0
+#endif
+
+/* v1 fixed layouts, still accepted on load */
+struct core_section_v1 {
+    uint32_t total_keystrokes;
+    uint32_t today_keystrokes;
+    uint32_t yesterday_keystrokes;
+    uint16_t current_uptime_day;
+} __packed;
+
+struct wpm_section_v1 {
+    uint8_t peak_wpm;
+    uint32_t total_typing_time_ms;
+} __packed;
+
+/* v2 field tags. Never reuse a tag; unknown tags are skipped on load. */
+enum core_tag {
+    CORE_TAG_TOTAL = 1,
+    CORE_TAG_TODAY = 2,
+    CORE_TAG_YESTERDAY = 3,
+    CORE_TAG_DAY = 4,
+    CORE_TAG_SAVES_ATTEMPTED = 5,
+    CORE_TAG_SAVES_SKIPPED = 6,
+    CORE_TAG_SAVE_FAILURES = 7,
+    CORE_TAG_FLASH_WRITES = 8,
+    CORE_TAG_BYTES_WRITTEN = 9,
+    CORE_TAG_MAX_SAVE_US = 10,
+    CORE_TAG_MAX_WRITE_US = 11,
+    CORE_TAG_RESET_EPOCH = 12,
+};
+
+enum wpm_tag {
+    WPM_TAG_PEAK = 1,
+    WPM_TAG_TYPING_TIME = 2,
+};
+
+/* Room for the scalar sections' fields, with some to spare for new ones */
+#define SCALAR_FIELDS_MAX 16
+
+/* Upper end of the DAILY_HISTORY_DAYS range */
+#define HISTORY_SECTION_DAYS_MAX 30
+
+/* Largest section payload for the configured features */
+union section_payload {
+    uint8_t fields[SCALAR_FIELDS_MAX * TLV_FIELD_MAX_BYTES];
+    struct core_section_v1 core;
+    struct wpm_section_v1 wpm;
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_KEY_HEATMAP
+    /* v2: compressed stream, at most one varint per key */
+    uint8_t heatmap[CONFIG_ZMK_KEYSTROKE_STATS_MAX_KEY_POSITIONS * VARINT_MAX_BYTES];
+    /* v1: raw counts */
+    uint32_t key_counts[CONFIG_ZMK_KEYSTROKE_STATS_MAX_KEY_POSITIONS];
+#endif
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_DAILY_HISTORY
+    /* Sized for the Kconfig maximum so a longer stored history is read whole */
+    struct zmk_keystroke_stats_daily_entry daily_history[HISTORY_SECTION_DAYS_MAX];
+#endif
+    uint8_t legacy[KEYSTROKE_STATS_LEGACY_DATA_MAX_BYTES];
+};
+
+/* The 4-byte header keeps the payload word aligned */
+struct section_buf {
+    struct section_header header;
+    union section_payload payload;
+    /* Room for the trailer after a full payload */
+    struct section_trailer trailer_room;
+};
+
+BUILD_ASSERT(offsetof(struct section_buf, payload) == sizeof(struct section_header),
+             "Section payload must directly follow the header");
+
+/*
+ * One buffer shared by loading and saving instead of a section-sized copy
+ * on the caller's stack (over 1 KB with a large heatmap). Held while a
+ * section is encoded and written, or read and decoded.
+ */
+static struct section_buf io_buf;
+K_MUTEX_DEFINE(io_mutex);
+
+/* Newest valid copy of each section, loaded or written */
+static struct {
+    uint16_t seq;
+    uint8_t slot;
+    bool valid;
+} slots[KEYSTROKE_STATS_SECTION_COUNT];
+
+/* Load state for the legacy record */
+static bool core_loaded;
+static bool legacy_found;
+static bool legacy_delete_pending;
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_STORAGE_DIRECT
+/* Statistics were moved over from settings, remove them there once checkpointed */
+static bool settings_cleanup_pending;
+#endif
+
+/* Section codecs, called with stats_mutex held */
+
+static size_t core_encode(const struct keystroke_stats_state *s, union section_payload *p) {
+    uint8_t *out = p->fields;
+    size_t size = sizeof(p->fields);
+    size_t len = 0;
+
+    len += tlv_put_u32(out + len, size - len, CORE_TAG_TOTAL, s->total_keystrokes);
+    len += tlv_put_u32(out + len, size - len, CORE_TAG_TODAY, s->today_keystrokes);
+    len += tlv_put_u32(out + len, size - len, CORE_TAG_YESTERDAY, s->yesterday_keystrokes);
+    len += tlv_put_u32(out + len, size - len, CORE_TAG_DAY, s->current_uptime_day);
+
+    /* Flash accounting as of this write; the write itself lands in the next one */
+    len += tlv_put_u32(out + len, size - len, CORE_TAG_SAVES_ATTEMPTED, s->flash.saves_attempted);
+    len += tlv_put_u32(out + len, size - len, CORE_TAG_SAVES_SKIPPED, s->flash.saves_skipped);
+    len += tlv_put_u32(out + len, size - len, CORE_TAG_SAVE_FAILURES, s->flash.save_failures);
+    len += tlv_put_u32(out + len, size - len, CORE_TAG_FLASH_WRITES, s->flash.writes);
+    len += tlv_put_u32(out + len, size - len, CORE_TAG_BYTES_WRITTEN, s->flash.bytes_written);
+    len += tlv_put_u32(out + len, size - len, CORE_TAG_MAX_SAVE_US, s->flash.max_save_us);
+    len += tlv_put_u32(out + len, size - len, CORE_TAG_MAX_WRITE_US, s->flash.max_write_us);
+    len += tlv_put_u32(out + len, size - len, CORE_TAG_RESET_EPOCH, s->reset_epoch);
+
+    return len;
+}
+
+static int core_decode(struct keystroke_stats_state *s, const union section_payload *p,
+                       size_t len, uint8_t version) {
+    if (version == 1) {
+        if (len != sizeof(p->core)) {
+            return -EINVAL;
+        }
+
+        s->total_keystrokes = p->core.total_keystrokes;
+        s->today_keystrokes = p->core.today_keystrokes;
+        s->yesterday_keystrokes = p->core.yesterday_keystrokes;
+        s->current_uptime_day = p->core.current_uptime_day;
+    } else {
+        struct tlv_field field;
+        size_t pos = 0;
+        int rc;
+
+        while ((rc = tlv_next(p->fields, len, &pos, &field)) > 0) {
+            switch (field.tag) {
+            case CORE_TAG_TOTAL:
+                s->total_keystrokes = tlv_get_u32(&field);
+                break;
+            case CORE_TAG_TODAY:
+                s->today_keystrokes = tlv_get_u32(&field);
+                break;
+            case CORE_TAG_YESTERDAY:
+                s->yesterday_keystrokes = tlv_get_u32(&field);
+                break;
+            case CORE_TAG_DAY:
+                s->current_uptime_day = (uint16_t)tlv_get_u32(&field);
+                break;
+            case CORE_TAG_SAVES_ATTEMPTED:
+                s->flash.saves_attempted = tlv_get_u32(&field);
+                break;
+            case CORE_TAG_SAVES_SKIPPED:
+                s->flash.saves_skipped = tlv_get_u32(&field);
+                break;
+            case CORE_TAG_SAVE_FAILURES:
+                s->flash.save_failures = tlv_get_u32(&field);
+                break;
+            case CORE_TAG_FLASH_WRITES:
+                s->flash.writes = tlv_get_u32(&field);
+                break;
+            case CORE_TAG_BYTES_WRITTEN:
+                s->flash.bytes_written = tlv_get_u32(&field);
+                break;
+            case CORE_TAG_MAX_SAVE_US:
+                s->flash.max_save_us = tlv_get_u32(&field);
+                break;
+            case CORE_TAG_MAX_WRITE_US:
+                s->flash.max_write_us = tlv_get_u32(&field);
+                break;
+            case CORE_TAG_RESET_EPOCH:
+                s->reset_epoch = tlv_get_u32(&field);
+                break;
+            default:
+                break;
+            }
+        }
+
+        if (rc < 0) {
+            return rc;
+        }
+    }
+
+    /* Keep counting from the stored day instead of restarting at uptime day 0 */
+    keystroke_stats_time_rebase(s->current_uptime_day);
+
+    return 0;
+}
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_WPM
+static size_t wpm_encode(const struct keystroke_stats_state *s, union section_payload *p) {
+    uint8_t *out = p->fields;
+    size_t size = sizeof(p->fields);
+    size_t len = 0;
+
+    len += tlv_put_u32(out + len, size - len, WPM_TAG_PEAK, s->peak_wpm);
+    len += tlv_put_u32(out + len, size - len, WPM_TAG_TYPING_TIME, s->total_typing_time_ms);
+
+    return len;
+}
+
+static int wpm_decode(struct keystroke_stats_state *s, const union section_payload *p,
+                      size_t len, uint8_t version) {
+    if (version == 1) {
+        if (len != sizeof(p->wpm)) {
+            return -EINVAL;
+        }
+
+        s->peak_wpm = p->wpm.peak_wpm;
+        s->total_typing_time_ms = p->wpm.total_typing_time_ms;
+        return 0;
+    }
+
+    struct tlv_field field;
+    size_t pos = 0;
+    int rc;
+
+    while ((rc = tlv_next(p->fields, len, &pos, &field)) > 0) {
+        switch (field.tag) {
+        case WPM_TAG_PEAK:
+            s->peak_wpm = (uint8_t)MIN(tlv_get_u32(&field), UINT8_MAX);
+            break;
+        case WPM_TAG_TYPING_TIME:
+            s->total_typing_time_ms = tlv_get_u32(&field);
+            break;
+        default:
+            break;
+        }
+    }
+
+    return rc;
+}
+#endif
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_KEY_HEATMAP
+/*
+ * Heatmap v2 stream: for each key the difference to the previous key's count
+ * as a zigzag varint. Runs of keys with the same count as the previous one
+ * (mostly unused positions at 0) are written as a 0 followed by a varint of
+ * the run length minus one. Positions past the end of the stream are 0.
+ */
+
+static size_t heatmap_encode(const struct keystroke_stats_state *s, union section_payload *p) {
+    const size_t num_keys = ARRAY_SIZE(s->key_counts);
+    uint8_t *out = p->heatmap;
+    size_t size = sizeof(p->heatmap);
+    size_t len = 0;
+    uint32_t prev = 0;
+    size_t i = 0;
+
+    while (i < num_keys) {
+        if (s->key_counts[i] != prev) {
+            uint32_t delta = s->key_counts[i] - prev;
+
+            len += varint_encode(zigzag_encode((int32_t)delta), out + len, size - len);
+            prev = s->key_counts[i++];
+            continue;
+        }
+
+        size_t run = 1;
+        while (i + run < num_keys && s->key_counts[i + run] == prev) {
+            run++;
+        }
+
+        /* Trailing zeros are implied */
+        if (prev == 0 && i + run == num_keys) {
+            break;
+        }
+
+        len += varint_encode(0, out + len, size - len);
+        len += varint_encode(run - 1, out + len, size - len);
+        i += run;
+    }
+
+    return len;
+}
+
+static int heatmap_decode(struct keystroke_stats_state *s, const union section_payload *p,
+                          size_t len, uint8_t version) {
+    const size_t num_keys = ARRAY_SIZE(s->key_counts);
+
+    memset(s->key_counts, 0, sizeof(s->key_counts));
+
+    if (version == 1) {
+        if (len % sizeof(uint32_t) != 0) {
+            return -EINVAL;
+        }
+
+        /* Tolerate a changed MAX_KEY_POSITIONS: keep what fits */
+        memcpy(s->key_counts, p->key_counts, MIN(len, sizeof(s->key_counts)));
+        return 0;
+    }
+
+    const uint8_t *in = p->heatmap;
+    size_t pos = 0;
+    uint32_t prev = 0;
+    size_t i = 0;
+
+    /* A stream for more keys than this build tracks is cut at num_keys */
+    while (pos < len && i < num_keys) {
+        uint32_t value;
+        size_t n = varint_decode(in + pos, len - pos, &value);
+        if (n == 0) {
+            return -EINVAL;
+        }
+        pos += n;
+
+        if (value != 0) {
+            prev += (uint32_t)zigzag_decode(value);
+            s->key_counts[i++] = prev;
+            continue;
+        }
+
+        uint32_t run;
+        n = varint_decode(in + pos, len - pos, &run);
+        if (n == 0) {
+            return -EINVAL;
+        }
+        pos += n;
+
+        for (uint64_t j = 0; j <= run && i < num_keys; j++) {
+            s->key_counts[i++] = prev;
+        }
+    }
+
+    return 0;
+}
+#endif
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_DAILY_HISTORY
+static size_t history_encode(const struct keystroke_stats_state *s, union section_payload *p) {
+    size_t len = s->daily_history_count * sizeof(s->daily_history[0]);
+
+    memcpy(p->daily_history, s->daily_history, len);
+
+    return len;
+}
+
+static int history_decode(struct keystroke_stats_state *s, const union section_payload *p,
+                          size_t len, uint8_t version) {
+    if (len % sizeof(s->daily_history[0]) != 0) {
+        return -EINVAL;
+    }
+
+    /* Entries are ordered by day; after shrinking DAILY_HISTORY_DAYS keep the newest */
+    size_t stored = len / sizeof(s->daily_history[0]);
+    size_t keep = MIN(stored, ARRAY_SIZE(s->daily_history));
+
+    memset(s->daily_history, 0, sizeof(s->daily_history));
+    memcpy(s->daily_history, &p->daily_history[stored - keep], keep * sizeof(s->daily_history[0]));
+    s->daily_history_count = keep;
+
+    return 0;
+}
+#endif
+
+struct section_desc {
+    const char *name;
+    /* Version written, and oldest version decode still understands */
+    uint8_t version;
+    uint8_t min_version;
+    /* NULL when the feature is disabled in this build */
+    size_t (*encode)(const struct keystroke_stats_state *s, union section_payload *p);
+    int (*decode)(struct keystroke_stats_state *s, const union section_payload *p, size_t len,
+                  uint8_t version);
+};
+
+static const struct section_desc sections[KEYSTROKE_STATS_SECTION_COUNT] = {
+    [KEYSTROKE_STATS_SECTION_CORE] = {"core", 2, 1, core_encode, core_decode},
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_WPM
+    [KEYSTROKE_STATS_SECTION_WPM] = {"wpm", 2, 1, wpm_encode, wpm_decode},
+#else
+    [KEYSTROKE_STATS_SECTION_WPM] = {"wpm", 2, 1, NULL, NULL},
+#endif
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_KEY_HEATMAP
+    [KEYSTROKE_STATS_SECTION_HEATMAP] = {"heatmap", 2, 1, heatmap_encode, heatmap_decode},
+#else
+    [KEYSTROKE_STATS_SECTION_HEATMAP] = {"heatmap", 2, 1, NULL, NULL},
+#endif
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_DAILY_HISTORY
+    [KEYSTROKE_STATS_SECTION_HISTORY] = {"history", 1, 1, history_encode, history_decode},
+#else
+    [KEYSTROKE_STATS_SECTION_HISTORY] = {"history", 1, 1, NULL, NULL},
+#endif
+};
+
+/**
+ * @brief Map a key to a section and slot
+ *
+ * @param slot Set to the slot: 0 for "<name>", 1 for "<name>/b"
+ */
+static int find_section(const char *key, uint8_t *slot) {
+    for (int i = 0; i < KEYSTROKE_STATS_SECTION_COUNT; i++) {
+        const char *next;
+
+        if (!settings_name_steq(key, sections[i].name, &next)) {
+            continue;
+        }
+
+        if (next == NULL) {
+            *slot = 0;
+            return i;
+        }
+
+        if (settings_name_steq(next, "b", NULL)) {
+            *slot = 1;
+            return i;
+        }
+    }
+
+    return -ENOENT;
+}
+
+/**
+ * @brief Settings key of a record, the inverse of find_section() for sections
+ */
+static void record_key(char *name, size_t size, uint16_t id) {
+    if (RECORD_ID_IS_SECTION(id)) {
+        snprintk(name, size, SETTINGS_KEY "/%s%s", sections[RECORD_ID_SECTION_IDX(id)].name,
+                 RECORD_ID_SECTION_SLOT(id) ? "/b" : "");
+    } else {
+        snprintk(name, size, SETTINGS_KEY "/j/%u", id - RECORD_ID_JOURNAL(0));
+    }
+}
+
+/* Sequence numbers wrap; only two copies are ever compared */
+static bool seq_newer(uint16_t a, uint16_t b) {
+    return (int16_t)(a - b) > 0;
+}
+
+static uint32_t section_crc(size_t len) {
+    return crc32_ieee((const uint8_t *)&io_buf, len);
+}
+
+/**
+ * @brief Read, check and decode one section copy through io_buf
+ *
+ * A copy older than one already decoded from the other slot is skipped.
+ * Called with io_mutex held.
+ *
+ * @return 0 if decoded, 1 if skipped as older, negative errno on failure
+ */
+static int read_section(int idx, uint8_t slot, size_t len, settings_read_cb read_cb,
+                        void *cb_arg) {
+    const struct section_desc *sec = &sections[idx];
+    uint16_t seq = 0;
+
+    /* Larger than this build can hold (e.g. fewer key positions): keep the start */
+    ssize_t rc = read_cb(cb_arg, &io_buf, MIN(len, sizeof(io_buf)));
+    if (rc < (ssize_t)sizeof(io_buf.header)) {
+        return rc < 0 ? (int)rc : -EIO;
+    }
+
+    size_t payload_len = rc - sizeof(io_buf.header);
+
+    if (io_buf.header.flags & SECTION_FLAG_CRC) {
+        struct section_trailer trailer;
+
+        if ((size_t)rc < len) {
+            /* Cannot be checked without reading it whole, only the start is used */
+            LOG_WRN("Section %s too large to verify (%zu bytes)", sec->name, len);
+        } else if (payload_len < sizeof(trailer)) {
+            return -EINVAL;
+        } else {
+            payload_len -= sizeof(trailer);
+            memcpy(&trailer, (uint8_t *)&io_buf.payload + payload_len, sizeof(trailer));
+            if (trailer.crc != section_crc(rc - sizeof(trailer.crc))) {
+                return -EBADMSG;
+            }
+            seq = trailer.seq;
+        }
+    }
+
+    if (slots[idx].valid && !seq_newer(seq, slots[idx].seq)) {
+        return 1;
+    }
+
+    if (io_buf.header.version < sec->min_version || io_buf.header.version > sec->version) {
+        return -ENOTSUP;
+    }
+
+    struct keystroke_stats_state *s = keystroke_stats_state_get();
+
+    k_mutex_lock(&stats_mutex, K_FOREVER);
+    int ret = sec->decode(s, &io_buf.payload, payload_len, io_buf.header.version);
+    if (ret == 0) {
+        keystroke_stats_journal_section_loaded(idx, io_buf.header.gen);
+        core_loaded |= idx == KEYSTROKE_STATS_SECTION_CORE;
+    }
+    k_mutex_unlock(&stats_mutex);
+
+    if (ret == 0) {
+        slots[idx].seq = seq;
+        slots[idx].slot = slot;
+        slots[idx].valid = true;
+        LOG_DBG("Loaded section %s slot %u (%zu bytes, gen %u, seq %u)", sec->name, slot, len,
+                io_buf.header.gen, seq);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Load one copy of a section, whichever backend it comes from
+ *
+ * Failures are logged and only affect this section.
+ */
+static int load_section_copy(int idx, uint8_t slot, size_t len, settings_read_cb read_cb,
+                             void *cb_arg) {
+    const struct section_desc *sec = &sections[idx];
+    if (sec->decode == NULL) {
+        LOG_DBG("Section %s disabled in this build, ignoring", sec->name);
+        return 0;
+    }
+
+    if (len < sizeof(io_buf.header)) {
+        LOG_WRN("Section %s truncated (%zu bytes), ignoring", sec->name, len);
+        return 0;
+    }
+
+    k_mutex_lock(&io_mutex, K_FOREVER);
+    int ret = read_section(idx, slot, len, read_cb, cb_arg);
+    k_mutex_unlock(&io_mutex);
+
+    if (ret == -EBADMSG) {
+        LOG_WRN("Section %s slot %u failed CRC check, ignoring", sec->name, slot);
+    } else if (ret < 0) {
+        LOG_WRN("Section %s slot %u not loaded (%zu bytes): %d", sec->name, slot, len, ret);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Settings callback for the section records
+ */
+static int load_section(const char *key, size_t len,
+                        settings_read_cb read_cb, void *cb_arg, void *param) {
+    ARG_UNUSED(param);
+
+    if (key == NULL) {
+        return 0;
+    }
+
+    uint8_t slot;
+    int idx = find_section(key, &slot);
+    if (idx < 0) {
+        /* Journal records and legacy data are loaded in later passes */
+        if (settings_name_steq(key, "data", NULL)) {
+            legacy_found = true;
+        } else if (strncmp(key, "j/", 2) != 0) {
+            LOG_WRN("Ignoring unknown settings key %s", key);
+        }
+        return 0;
+    }
 
-/* Note: struct zmk_keystroke_stats_persist_data is now defined in the public header.
- * This matches the layout of the old 'struct persisted_data'.
- * We use the public API functions zmk_keystroke_stats_get_persist_data() and
- * zmk_keystroke_stats_load_persist_data() to access the internal state.
+    return load_section_copy(idx, slot, len, read_cb, cb_arg);
+}
+
+/**
+ * @brief Migrate the legacy single-record format
  */
+static int load_legacy_data(const char *key, size_t len,
+                            settings_read_cb read_cb, void *cb_arg, void *param) {
+    ARG_UNUSED(param);
+
+    /* Only the exact "data" key, not anything below it */
+    if (key != NULL) {
+        return 0;
+    }
+
+    k_mutex_lock(&io_mutex, K_FOREVER);
+
+    ssize_t rc = read_cb(cb_arg, io_buf.payload.legacy, MIN(len, sizeof(io_buf.payload.legacy)));
+    if (rc >= 0) {
+        k_mutex_lock(&stats_mutex, K_FOREVER);
+        rc = keystroke_stats_migrate_legacy(io_buf.payload.legacy, rc, len);
+        k_mutex_unlock(&stats_mutex);
+    }
+
+    k_mutex_unlock(&io_mutex);
+
+    if (rc < 0) {
+        LOG_ERR("Failed to migrate legacy statistics: %d", (int)rc);
+        return 0;
+    }
+
+    /* Keep the old record until the migrated data is safely written */
+    legacy_delete_pending = true;
+    return 0;
+}
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_JOURNAL
+/**
+ * @brief Load one journal record and apply it on top of the loaded sections
+ *
+ * @param name Record name for log messages
+ */
+static void load_journal_copy(const char *name, size_t len, settings_read_cb read_cb,
+                              void *cb_arg) {
+    uint8_t buf[CONFIG_ZMK_KEYSTROKE_STATS_JOURNAL_RECORD_MAX_BYTES];
+
+    if (len > sizeof(buf)) {
+        LOG_WRN("Journal record %s too large (%zu bytes), skipping", name, len);
+        return;
+    }
+
+    int rc = read_cb(cb_arg, buf, len);
+    if (rc < 0) {
+        LOG_ERR("Failed to read journal record %s: %d", name, rc);
+        return;
+    }
+
+    rc = keystroke_stats_journal_replay(buf, len);
+    if (rc == -EINVAL) {
+        LOG_WRN("Corrupt journal record %s, skipping", name);
+    }
+}
+
+static int load_journal_record(const char *key, size_t len,
+                               settings_read_cb read_cb, void *cb_arg, void *param) {
+    ARG_UNUSED(param);
+
+    load_journal_copy(key, len, read_cb, cb_arg);
+
+    /* Never abort loading because of a single record */
+    return 0;
+}
+#endif /* CONFIG_ZMK_KEYSTROKE_STATS_JOURNAL */
 
 /**
  * @brief Settings load callback
  *
- * Called by Zephyr settings subsystem when loading persisted data.
+ * Our records are loaded directly by keystroke_stats_load_from_settings()
+ * during init, in a defined order (sections before journal). Loading them
+ * again when the application calls settings_load() would clobber live
+ * counters and replay the journal twice, so this handler ignores them.
  */
 static int settings_load_handler(const char *key, size_t len,
                                   settings_read_cb read_cb, void *cb_arg) {
-    const char *next;
-    size_t name_len;
+    ARG_UNUSED(key);
+    ARG_UNUSED(len);
+    ARG_UNUSED(read_cb);
+    ARG_UNUSED(cb_arg);
 
-    name_len = settings_name_next(key, &next);
+    return 0;
+}
 
-    if (!next) {
-        /* Root key: "keystroke_stats" */
-        if (!strncmp(key, "data", name_len)) {
-            struct zmk_keystroke_stats_persist_data data;
+/**
+ * @brief Write one record and account for it in the flash telemetry
+ *
+ * @param cb Settings write function, unused with a direct backend
+ * @param id Record ID, turned into a settings key when going through settings
+ */
+static int timed_write(int (*cb)(const char *name, const void *value, size_t val_len),
+                       uint16_t id, const void *value, size_t len) {
+    struct keystroke_stats_state *s = keystroke_stats_state_get();
+    uint32_t start = k_cycle_get_32();
+#if CONFIG_ZMK_KEYSTROKE_STATS_STORAGE_DIRECT
+    ARG_UNUSED(cb);
+    int rc = keystroke_stats_store_write(id, value, len);
+#else
+    char name[sizeof(SETTINGS_KEY) + 16];
 
-            if (len != sizeof(data)) {
-                LOG_ERR("Persisted data size mismatch: expected %zu, got %zu",
-                        sizeof(data), len);
-                return -EINVAL;
-            }
+    record_key(name, sizeof(name), id);
+    int rc = cb(name, value, len);
+#endif
+    uint32_t us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
 
-            int rc = read_cb(cb_arg, &data, sizeof(data));
-            if (rc < 0) {
-                LOG_ERR("Failed to read settings: %d", rc);
-                return rc;
-            }
+    k_mutex_lock(&stats_mutex, K_FOREVER);
+    s->flash.writes++;
+    if (rc == 0) {
+        s->flash.bytes_written += len;
+    }
+    if (us > s->flash.max_write_us) {
+        s->flash.max_write_us = us;
+        LOG_DBG("New max write latency: %u us (record 0x%x, %zu bytes)", us, id, len);
+    }
+    k_mutex_unlock(&stats_mutex);
 
-            /* Version check and load via public API */
-            if (data.version != SETTINGS_VERSION) {
-                LOG_WRN("Settings version mismatch: %u != %u (ignoring)",
-                        data.version, SETTINGS_VERSION);
-                return 0;
-            }
+    return rc;
+}
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_STORAGE_DIRECT
+static int remove_setting(uint16_t id) {
+    char name[sizeof(SETTINGS_KEY) + 16];
 
-            /* Use public API to load data (provides mutex protection) */
-            rc = zmk_keystroke_stats_load_persist_data(&data);
-            if (rc < 0) {
-                LOG_ERR("Failed to load persist data: %d", rc);
-                return rc;
+    record_key(name, sizeof(name), id);
+
+    int rc = settings_delete(name);
+    if (rc < 0) {
+        LOG_WRN("Failed to remove %s from settings: %d", name, rc);
+    }
+
+    return rc;
+}
+
+/**
+ * @brief Delete the records moved over from settings
+ *
+ * Called once the moved statistics are checkpointed in the direct backend.
+ * Deleting a key that does not exist writes nothing.
+ */
+static void remove_settings_records(void) {
+    for (int i = 0; i < KEYSTROKE_STATS_SECTION_COUNT; i++) {
+        for (uint8_t slot = 0; slot < SECTION_SLOTS; slot++) {
+            if (remove_setting(RECORD_ID_SECTION(i, slot)) < 0) {
+                return;
             }
+        }
+    }
+
+    for (int seq = 0; seq < JOURNAL_RECORDS; seq++) {
+        if (remove_setting(RECORD_ID_JOURNAL(seq)) < 0) {
+            return;
+        }
+    }
+
+    LOG_INF("Removed statistics moved out of settings");
+    settings_cleanup_pending = false;
+}
+#endif /* CONFIG_ZMK_KEYSTROKE_STATS_STORAGE_DIRECT */
+
+/**
+ * @brief Write sections
+ *
+ * With the journal enabled this is a checkpoint: core is always written
+ * (it carries the new generation) and goes last, so an interrupted
+ * checkpoint leaves the previous generation in effect.
+ *
+ * @param cb Write function (settings_save_one or the export callback)
+ * @param mask Sections to consider; only dirty ones are written
+ * @return Number of sections written, negative errno on failure
+ */
+static int save_sections(int (*cb)(const char *name, const void *value, size_t val_len),
+                         uint8_t mask) {
+    struct keystroke_stats_state *s = keystroke_stats_state_get();
+    int written = 0;
+    int rc = 0;
 
-            LOG_INF("Loaded persisted statistics:");
-            LOG_INF("  Total keystrokes: %u", data.total_keystrokes);
-            LOG_INF("  Today: %u, Yesterday: %u",
-                    data.today_keystrokes, data.yesterday_keystrokes);
-            LOG_INF("  Uptime day: %u", data.current_uptime_day);
+    /* Also keeps concurrent checkpoints (export vs. save work) apart */
+    k_mutex_lock(&io_mutex, K_FOREVER);
 
-            return 0;
+    k_mutex_lock(&stats_mutex, K_FOREVER);
+    uint8_t dirty = s->dirty_sections & mask;
+#if CONFIG_ZMK_KEYSTROKE_STATS_JOURNAL
+    dirty |= BIT(KEYSTROKE_STATS_SECTION_CORE);
+#endif
+    uint16_t gen = dirty ? keystroke_stats_journal_checkpoint_begin() : 0;
+    k_mutex_unlock(&stats_mutex);
+
+    for (int i = KEYSTROKE_STATS_SECTION_COUNT - 1; i >= 0; i--) {
+        const struct section_desc *sec = &sections[i];
+
+        if (!(dirty & BIT(i)) || sec->encode == NULL) {
+            continue;
         }
+
+        /* Snapshot and clear the dirty bit (and matching journal deltas) atomically */
+        k_mutex_lock(&stats_mutex, K_FOREVER);
+        io_buf.header.version = sec->version;
+        io_buf.header.flags = SECTION_FLAG_CRC;
+        io_buf.header.gen = gen;
+        size_t len = sec->encode(s, &io_buf.payload);
+        s->dirty_sections &= ~BIT(i);
+        keystroke_stats_journal_section_saved(i);
+        k_mutex_unlock(&stats_mutex);
+
+        /* Never overwrite the newest good copy */
+        uint8_t slot = slots[i].valid ? (slots[i].slot + 1) % SECTION_SLOTS : 0;
+        struct section_trailer trailer = {
+            .seq = slots[i].valid ? slots[i].seq + 1 : 1,
+        };
+        size_t total = sizeof(io_buf.header) + len + sizeof(trailer);
+        uint32_t start = k_cycle_get_32();
+
+        memcpy((uint8_t *)&io_buf.payload + len, &trailer, sizeof(trailer));
+        trailer.crc = section_crc(total - sizeof(trailer.crc));
+        memcpy((uint8_t *)&io_buf + total - sizeof(trailer.crc), &trailer.crc,
+               sizeof(trailer.crc));
+        LOG_DBG("CRC of section %s (%zu bytes) took %u us", sec->name, total,
+                k_cyc_to_us_floor32(k_cycle_get_32() - start));
+
+        rc = timed_write(cb, RECORD_ID_SECTION(i, slot), &io_buf, total);
+        if (rc < 0) {
+            LOG_ERR("Failed to write section %s: %d", sec->name, rc);
+
+            k_mutex_lock(&stats_mutex, K_FOREVER);
+            s->dirty_sections |= BIT(i);
+            k_mutex_unlock(&stats_mutex);
+            break;
+        }
+
+        slots[i].seq = trailer.seq;
+        slots[i].slot = slot;
+        slots[i].valid = true;
+
+        LOG_DBG("Wrote section %s slot %u (%zu bytes, gen %u, seq %u)", sec->name, slot, total,
+                gen, trailer.seq);
+        written++;
     }
 
-    return -ENOENT;
+    if (dirty) {
+        keystroke_stats_journal_checkpoint_done(rc);
+    }
+
+    if (rc == 0 && legacy_delete_pending && (dirty & BIT(KEYSTROKE_STATS_SECTION_CORE))) {
+        if (settings_delete(SETTINGS_KEY "/data") == 0) {
+            LOG_INF("Removed legacy statistics record");
+            legacy_delete_pending = false;
+        }
+    }
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_STORAGE_DIRECT
+    if (rc == 0 && settings_cleanup_pending && (dirty & BIT(KEYSTROKE_STATS_SECTION_CORE))) {
+        remove_settings_records();
+    }
+#endif
+
+    k_mutex_unlock(&io_mutex);
+
+    return rc < 0 ? rc : written;
 }
 
+#if !CONFIG_ZMK_KEYSTROKE_STATS_STORAGE_DIRECT
 /**
  * @brief Settings export callback
  *
@@ -89,63 +913,228 @@ static int settings_load_handler(const char *key, size_t len,
 static int settings_export_handler(int (*cb)(const char *name,
                                               const void *value,
                                               size_t val_len)) {
-    struct zmk_keystroke_stats_persist_data data;
-
-    /* Use public API to get data (provides mutex protection) */
-    int rc = zmk_keystroke_stats_get_persist_data(&data);
-    if (rc < 0) {
-        LOG_ERR("Failed to get persist data: %d", rc);
-        return rc;
-    }
-
-    /* Save to settings */
-    rc = cb(SETTINGS_KEY "/data", &data, sizeof(data));
-    if (rc < 0) {
-        LOG_ERR("Failed to export settings: %d", rc);
-        return rc;
-    }
+    struct keystroke_stats_state *s = keystroke_stats_state_get();
 
-    LOG_DBG("Exported statistics to settings (%zu bytes)", sizeof(data));
+    /* A full export writes everything, dirty or not */
+    k_mutex_lock(&stats_mutex, K_FOREVER);
+    s->dirty_sections = KEYSTROKE_STATS_SECTIONS_ALL;
+    k_mutex_unlock(&stats_mutex);
 
-    return 0;
+    int rc = save_sections(cb, KEYSTROKE_STATS_SECTIONS_ALL);
+    return rc < 0 ? rc : 0;
 }
 
+#define EXPORT_HANDLER settings_export_handler
+#else
+/* settings_save() must not copy the statistics back into settings */
+#define EXPORT_HANDLER NULL
+#endif
+
 /* Settings handler structure */
 SETTINGS_STATIC_HANDLER_DEFINE(keystroke_stats_settings, SETTINGS_KEY,
                                 NULL,  /* get */
                                 settings_load_handler,
                                 NULL,  /* commit */
-                                settings_export_handler);
+                                EXPORT_HANDLER);
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_JOURNAL
+/**
+ * @brief Append a journal record with the changes since the last save
+ *
+ * @return 0 if written or nothing changed, -ENOSPC if a checkpoint is needed
+ */
+static int save_journal_record(void) {
+    uint8_t buf[CONFIG_ZMK_KEYSTROKE_STATS_JOURNAL_RECORD_MAX_BYTES];
+    uint8_t seq;
+
+    int len = keystroke_stats_journal_build(buf, sizeof(buf), &seq);
+    if (len <= 0) {
+        if (len == 0) {
+            LOG_DBG("No changes since last save");
+        }
+        return len;
+    }
+
+    int rc = timed_write(settings_save_one, RECORD_ID_JOURNAL(seq), buf, len);
+    keystroke_stats_journal_record_done(rc);
+    if (rc < 0) {
+        LOG_ERR("Failed to append journal record: %d", rc);
+        return rc;
+    }
+
+    LOG_DBG("Appended journal record %u (%d bytes)", seq, len);
+    return 0;
+}
+#endif /* CONFIG_ZMK_KEYSTROKE_STATS_JOURNAL */
 
 /**
  * @brief Save current statistics to persistent storage
  *
- * Called by keystroke_stats.c save work handler.
+ * Called by keystroke_stats.c save work handler. Appends a journal record
+ * when possible and falls back to a checkpoint of the dirty sections when
+ * the journal is full or the changes do not fit a record.
  */
 int keystroke_stats_save_to_settings(void) {
-    int rc = settings_save_one(SETTINGS_KEY "/data", NULL, 0);
+    int rc;
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_JOURNAL
+    rc = save_journal_record();
+    if (rc != -ENOSPC) {
+        return rc;
+    }
+#endif
+
+    rc = save_sections(settings_save_one, KEYSTROKE_STATS_SECTIONS_ALL);
     if (rc < 0) {
         LOG_ERR("Failed to save settings: %d", rc);
         return rc;
     }
 
-    LOG_DBG("Statistics saved to persistent storage");
+    LOG_DBG("Statistics saved to persistent storage (%d sections)", rc);
     return 0;
 }
 
+/**
+ * @brief Load sections, legacy data and journal from the settings subtree
+ */
+static int load_settings(void) {
+    int rc = settings_load_subtree_direct(SETTINGS_KEY, load_section, NULL);
+    if (rc < 0) {
+        LOG_ERR("Failed to load settings: %d", rc);
+        return rc;
+    }
+
+    if (legacy_found) {
+        if (core_loaded) {
+            /* Already migrated, only the delete did not happen */
+            legacy_delete_pending = true;
+        } else {
+            settings_load_subtree_direct(SETTINGS_KEY "/data", load_legacy_data, NULL);
+        }
+    }
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_JOURNAL
+    rc = settings_load_subtree_direct(SETTINGS_KEY "/j", load_journal_record, NULL);
+    keystroke_stats_journal_replay_done();
+    if (rc < 0) {
+        LOG_ERR("Failed to load journal: %d", rc);
+        return rc;
+    }
+#endif
+
+    return 0;
+}
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_STORAGE_DIRECT
+/* Adapts the direct backend to the settings read callback, cb_arg is the ID */
+static ssize_t store_read_cb(void *cb_arg, void *data, size_t len) {
+    return keystroke_stats_store_read(*(uint16_t *)cb_arg, data, len);
+}
+
+/**
+ * @brief Load sections and journal from the direct backend
+ *
+ * Without a core section nothing has been checkpointed here yet and the
+ * journal is not read.
+ */
+static void load_direct(void) {
+    for (int i = 0; i < KEYSTROKE_STATS_SECTION_COUNT; i++) {
+        for (uint8_t slot = 0; slot < SECTION_SLOTS; slot++) {
+            uint16_t id = RECORD_ID_SECTION(i, slot);
+            ssize_t len = keystroke_stats_store_length(id);
+
+            if (len == -ENOENT) {
+                continue;
+            }
+            if (len < 0) {
+                LOG_WRN("Section %s slot %u not readable: %d", sections[i].name, slot, (int)len);
+                continue;
+            }
+
+            load_section_copy(i, slot, len, store_read_cb, &id);
+        }
+    }
+
+    if (!core_loaded) {
+        return;
+    }
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_JOURNAL
+    for (int seq = 0; seq < JOURNAL_RECORDS; seq++) {
+        uint16_t id = RECORD_ID_JOURNAL(seq);
+        ssize_t len = keystroke_stats_store_length(id);
+        char name[4];
+
+        if (len < 0) {
+            continue;
+        }
+
+        snprintk(name, sizeof(name), "%u", seq);
+        load_journal_copy(name, len, store_read_cb, &id);
+    }
+    keystroke_stats_journal_replay_done();
+#endif
+}
+#endif /* CONFIG_ZMK_KEYSTROKE_STATS_STORAGE_DIRECT */
+
 /**
  * @brief Load statistics from persistent storage
  *
- * Called during module initialization.
+ * Called during module initialization. With a direct backend, statistics
+ * are taken from settings only while the backend has no checkpoint yet.
  */
 int keystroke_stats_load_from_settings(void) {
-    /* Settings framework automatically calls our load handler */
-    int rc = settings_load_subtree(SETTINGS_KEY);
+    int rc;
+
+    core_loaded = false;
+    legacy_found = false;
+    memset(slots, 0, sizeof(slots));
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_STORAGE_DIRECT
+    rc = keystroke_stats_store_init();
     if (rc < 0) {
-        LOG_ERR("Failed to load settings: %d", rc);
         return rc;
     }
 
+    load_direct();
+
+    if (!core_loaded) {
+        rc = load_settings();
+        if (rc < 0) {
+            return rc;
+        }
+
+        if (core_loaded || legacy_found) {
+            struct keystroke_stats_state *s = keystroke_stats_state_get();
+
+            LOG_INF("Moving statistics from settings to the direct backend");
+
+            /* Settings slots and sequence numbers mean nothing here */
+            memset(slots, 0, sizeof(slots));
+            k_mutex_lock(&stats_mutex, K_FOREVER);
+            s->dirty_sections = KEYSTROKE_STATS_SECTIONS_ALL;
+            keystroke_stats_journal_invalidate();
+            k_mutex_unlock(&stats_mutex);
+            settings_cleanup_pending = true;
+        }
+    }
+#else
+    rc = load_settings();
+    if (rc < 0) {
+        return rc;
+    }
+#endif
+
+    /* The public getters refuse to answer until loading has finished */
+    struct keystroke_stats_state *s = keystroke_stats_state_get();
+
+    k_mutex_lock(&stats_mutex, K_FOREVER);
+    LOG_INF("Loaded persisted statistics:");
+    LOG_INF("  Total keystrokes: %u", s->total_keystrokes);
+    LOG_INF("  Today: %u, Yesterday: %u", s->today_keystrokes, s->yesterday_keystrokes);
+    LOG_INF("  Day: %u", s->current_uptime_day);
+    k_mutex_unlock(&stats_mutex);
+
     return 0;
 }
 
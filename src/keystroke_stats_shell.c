@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <stdlib.h>
+#include <zmk/keystroke_stats.h>
+
+#include "keystroke_stats_internal.h"
+
+/**
+ * @brief Shell commands for keystroke statistics
+ *
+ * kstats time                      - Show wall-clock time (if set)
+ * kstats time <epoch> [offset_min] - Set wall-clock time, e.g.
+ *                                    "kstats time $(date +%s) 540"
+ * kstats save                      - Show save scheduler state
+ */
+
+static int cmd_time(const struct shell *sh, size_t argc, char **argv) {
+    if (argc == 1) {
+        int64_t epoch_s;
+        int ret = zmk_keystroke_stats_get_time(&epoch_s);
+        if (ret < 0) {
+            shell_print(sh, "Time not set");
+            return 0;
+        }
+
+        shell_print(sh, "Epoch: %lld", (long long)epoch_s);
+        return 0;
+    }
+
+    char *end;
+    int64_t epoch_s = strtoll(argv[1], &end, 10);
+    if (*end != '\0') {
+        shell_error(sh, "Invalid epoch: %s", argv[1]);
+        return -EINVAL;
+    }
+
+    long offset_min = 0;
+    if (argc > 2) {
+        offset_min = strtol(argv[2], &end, 10);
+        if (*end != '\0' || offset_min < INT16_MIN || offset_min > INT16_MAX) {
+            shell_error(sh, "Invalid UTC offset: %s", argv[2]);
+            return -EINVAL;
+        }
+    }
+
+    int ret = zmk_keystroke_stats_set_time(epoch_s, (int16_t)offset_min);
+    if (ret < 0) {
+        shell_error(sh, "Failed to set time: %d", ret);
+        return ret;
+    }
+
+    shell_print(sh, "Time set");
+    return 0;
+}
+
+static int cmd_save(const struct shell *sh, size_t argc, char **argv) {
+    struct keystroke_stats_save_status status;
+    struct zmk_keystroke_stats_flash_telemetry flash;
+
+    keystroke_stats_save_status_get(&status);
+    zmk_keystroke_stats_get_flash_telemetry(&flash);
+
+    shell_print(sh, "Unsaved keystrokes: %u", status.unsaved_keystrokes);
+    shell_print(sh, "Unsaved for: %u s", status.unsaved_age_ms / 1000);
+    shell_print(sh, "Saves since boot: %u", status.save_count);
+    if (status.projected_lifespan_days > 0) {
+        shell_print(sh, "Projected flash lifespan: %u days", status.projected_lifespan_days);
+    } else {
+        shell_print(sh, "Projected flash lifespan: no saves yet");
+    }
+
+    shell_print(sh, "Saves attempted: %u (%u skipped, %u failed)", flash.saves_attempted,
+                flash.saves_skipped, flash.save_failures);
+    shell_print(sh, "Flash writes: %u (%u bytes)", flash.writes, flash.bytes_written);
+    shell_print(sh, "Save time: last %u us, max %u us", flash.last_save_us, flash.max_save_us);
+    shell_print(sh, "Max write latency: %u us", flash.max_write_us);
+    if (flash.since_last_save_ms != UINT32_MAX) {
+        shell_print(sh, "Last save: %u s ago", flash.since_last_save_ms / 1000);
+    } else {
+        shell_print(sh, "Last save: none since boot");
+    }
+
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(kstats_cmds,
+    SHELL_CMD_ARG(time, NULL, "Get or set wall-clock time: [epoch_s [utc_offset_min]]",
+                  cmd_time, 1, 2),
+    SHELL_CMD(save, NULL, "Show save scheduler state and flash telemetry", cmd_save),
+    SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(kstats, &kstats_cmds, "Keystroke statistics", NULL);
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/storage/flash_map.h>
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_STORAGE_ZMS
+#include <zephyr/fs/zms.h>
+#else
+#include <zephyr/fs/nvs.h>
+#endif
+
+#include "keystroke_stats_internal.h"
+
+LOG_MODULE_REGISTER(keystroke_stats_store, CONFIG_ZMK_KEYSTROKE_STATS_LOG_LEVEL);
+
+/*
+ * Records live in their own flash partition (devicetree label
+ * "kstats_partition") under numeric IDs, bypassing the settings layer:
+ * no key strings to build and parse, no name records, and no sharing of
+ * garbage collection with the BLE bonds and keymap stored in settings.
+ *
+ * NVS and ZMS have the same shape; the few calls that differ are mapped
+ * below.
+ */
+
+#define STORE_PARTITION kstats_partition
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_STORAGE_ZMS
+static struct zms_fs fs;
+#define store_mount(fs) zms_mount(fs)
+#define store_fs_write(fs, id, data, len) zms_write(fs, id, data, len)
+#define store_fs_read(fs, id, data, len) zms_read(fs, id, data, len)
+#define store_fs_length(fs, id) zms_get_data_length(fs, id)
+#else
+static struct nvs_fs fs;
+#define store_mount(fs) nvs_mount(fs)
+#define store_fs_write(fs, id, data, len) nvs_write(fs, id, data, len)
+#define store_fs_read(fs, id, data, len) nvs_read(fs, id, data, len)
+/* Reading zero bytes returns the stored length */
+#define store_fs_length(fs, id) nvs_read(fs, id, NULL, 0)
+#endif
+
+static bool mounted;
+
+int keystroke_stats_store_init(void) {
+    struct flash_pages_info info;
+    int rc;
+
+    if (mounted) {
+        return 0;
+    }
+
+    fs.flash_device = FIXED_PARTITION_DEVICE(STORE_PARTITION);
+    if (!device_is_ready(fs.flash_device)) {
+        LOG_ERR("Flash device for the statistics partition is not ready");
+        return -ENODEV;
+    }
+
+    fs.offset = FIXED_PARTITION_OFFSET(STORE_PARTITION);
+    rc = flash_get_page_info_by_offs(fs.flash_device, fs.offset, &info);
+    if (rc < 0) {
+        LOG_ERR("Failed to get flash page info: %d", rc);
+        return rc;
+    }
+
+    fs.sector_size = info.size;
+    fs.sector_count = FIXED_PARTITION_SIZE(STORE_PARTITION) / info.size;
+
+    rc = store_mount(&fs);
+    if (rc < 0) {
+        LOG_ERR("Failed to mount statistics partition: %d", rc);
+        return rc;
+    }
+
+    mounted = true;
+    LOG_INF("Statistics partition mounted (%u sectors of %u bytes)", fs.sector_count,
+            (uint32_t)fs.sector_size);
+
+    return 0;
+}
+
+int keystroke_stats_store_write(uint16_t id, const void *data, size_t len) {
+    if (!mounted) {
+        return -ENODEV;
+    }
+
+    /* Returns the bytes written, 0 if the same data was already stored */
+    ssize_t rc = store_fs_write(&fs, id, data, len);
+
+    return rc < 0 ? (int)rc : 0;
+}
+
+ssize_t keystroke_stats_store_read(uint16_t id, void *data, size_t len) {
+    if (!mounted) {
+        return -ENODEV;
+    }
+
+    ssize_t rc = store_fs_read(&fs, id, data, len);
+
+    return rc < 0 ? rc : (ssize_t)MIN((size_t)rc, len);
+}
+
+ssize_t keystroke_stats_store_length(uint16_t id) {
+    if (!mounted) {
+        return -ENODEV;
+    }
+
+    return store_fs_length(&fs, id);
+}
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "keystroke_stats_internal.h"
+
+LOG_MODULE_REGISTER(keystroke_stats_time, CONFIG_ZMK_KEYSTROKE_STATS_LOG_LEVEL);
+
+/**
+ * @brief Wall-clock time anchor
+ *
+ * Keyboards have no RTC, so the host pushes the current epoch time (shell,
+ * or any transport calling zmk_keystroke_stats_set_time()). We only keep the
+ * offset between uptime and local wall-clock time and derive day numbers
+ * from it.
+ *
+ * The end of the current day is cached as an uptime value, so checking for a
+ * day change on every keystroke is a single 64-bit compare.
+ *
+ * Until the time is known, days are counted in 24h blocks of uptime starting
+ * from the last persisted day number instead of restarting at zero on every
+ * boot.
+ */
+
+#define MS_PER_HOUR 3600000LL
+#define MS_PER_DAY (24 * MS_PER_HOUR)
+#define ROLLOVER_OFFSET_MS (CONFIG_ZMK_KEYSTROKE_STATS_DAY_ROLLOVER_HOUR * MS_PER_HOUR)
+
+static struct {
+    /* Host has provided wall-clock time since boot */
+    bool synced;
+
+    /* Local wall-clock time in ms at uptime 0 (valid if synced) */
+    int64_t offset_ms;
+
+    /* UTC offset supplied with the time, needed to report epoch time back */
+    int16_t utc_offset_min;
+
+    /* Day number at uptime 0 when not synced */
+    uint16_t base_day;
+
+    /* Cached current day and the uptime at which it ends */
+    uint16_t day;
+    int64_t next_boundary_ms;
+} clock;
+
+/**
+ * @brief Recompute the cached day and its end boundary
+ */
+static void recompute_day(int64_t now_ms) {
+    if (clock.synced) {
+        int64_t local_ms = now_ms + clock.offset_ms - ROLLOVER_OFFSET_MS;
+        int64_t day = local_ms / MS_PER_DAY;
+
+        clock.day = (uint16_t)day;
+        clock.next_boundary_ms = (day + 1) * MS_PER_DAY + ROLLOVER_OFFSET_MS - clock.offset_ms;
+    } else {
+        int64_t adjusted_ms = MAX(now_ms - ROLLOVER_OFFSET_MS, 0);
+        int64_t elapsed_days = adjusted_ms / MS_PER_DAY;
+
+        clock.day = (uint16_t)(clock.base_day + elapsed_days);
+        clock.next_boundary_ms = (elapsed_days + 1) * MS_PER_DAY + ROLLOVER_OFFSET_MS;
+    }
+}
+
+uint16_t keystroke_stats_time_get_day(int64_t now_ms) {
+    if (now_ms >= clock.next_boundary_ms) {
+        recompute_day(now_ms);
+    }
+
+    return clock.day;
+}
+
+void keystroke_stats_time_rebase(uint16_t day) {
+    if (clock.synced) {
+        return;
+    }
+
+    int64_t now_ms = k_uptime_get();
+    int64_t elapsed_days = MAX(now_ms - ROLLOVER_OFFSET_MS, 0) / MS_PER_DAY;
+
+    clock.base_day = (uint16_t)(day - elapsed_days);
+    recompute_day(now_ms);
+
+    LOG_DBG("Day counter rebased to %u", clock.day);
+}
+
+uint16_t keystroke_stats_time_set(int64_t epoch_s, int16_t utc_offset_min) {
+    int64_t now_ms = k_uptime_get();
+
+    clock.offset_ms = (epoch_s + (int64_t)utc_offset_min * 60) * 1000 - now_ms;
+    clock.utc_offset_min = utc_offset_min;
+    clock.synced = true;
+    recompute_day(now_ms);
+
+    LOG_INF("Wall-clock time set: epoch=%lld, utc_offset=%d min, day=%u",
+            (long long)epoch_s, utc_offset_min, clock.day);
+
+    return clock.day;
+}
+
+bool keystroke_stats_time_is_synced(void) {
+    return clock.synced;
+}
+
+int keystroke_stats_time_get_epoch(int64_t *epoch_s) {
+    if (!clock.synced) {
+        return -EAGAIN;
+    }
+
+    *epoch_s = (k_uptime_get() + clock.offset_ms) / 1000 - (int64_t)clock.utc_offset_min * 60;
+
+    return 0;
+}
+
+/*
+ * Calendar conversion for days since 1970-01-01 (proleptic Gregorian), using
+ * the era-based algorithm from Howard Hinnant's "chrono-compatible low-level
+ * date algorithms". Integer only, no tables.
+ */
+
+int zmk_keystroke_stats_day_to_date(uint16_t day, uint16_t *year, uint8_t *month, uint8_t *mday) {
+    if (year == NULL || month == NULL || mday == NULL ||
+        !keystroke_stats_day_is_calendar(day)) {
+        return -EINVAL;
+    }
+
+    /* Shift epoch to 0000-03-01 so leap days fall at the end of the year */
+    uint32_t z = (uint32_t)day + 719468;
+    uint32_t era = z / 146097;
+    uint32_t doe = z - era * 146097;
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    uint32_t mp = (5 * doy + 2) / 153;
+    uint32_t m = mp < 10 ? mp + 3 : mp - 9;
+
+    *year = (uint16_t)(yoe + era * 400 + (m <= 2));
+    *month = (uint8_t)m;
+    *mday = (uint8_t)(doy - (153 * mp + 2) / 5 + 1);
+
+    return 0;
+}
+
+static uint8_t days_in_month(uint16_t year, uint8_t month) {
+    if (month == 2) {
+        bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+
+        return leap ? 29 : 28;
+    }
+
+    /* 31 days in odd months up to July, in even months from August */
+    return 30 + ((month ^ (month >> 3)) & 1);
+}
+
+uint16_t zmk_keystroke_stats_date_to_day(uint16_t year, uint8_t month, uint8_t mday) {
+    if (year < 1970 || month < 1 || month > 12 || mday < 1 ||
+        mday > days_in_month(year, month)) {
+        return 0;
+    }
+
+    uint32_t y = year - (month <= 2);
+    uint32_t era = y / 400;
+    uint32_t yoe = y - era * 400;
+    uint32_t doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + mday - 1;
+    uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    uint32_t days = era * 146097 + doe - 719468;
+
+    return days > UINT16_MAX ? 0 : (uint16_t)days;
+}
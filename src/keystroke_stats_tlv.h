@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <errno.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @file keystroke_stats_tlv.h
+ * @brief Tag-length-value helpers for persisted scalar fields
+ *
+ * Each field is a 1-byte tag, a 1-byte length and the value in little endian
+ * with leading zero bytes dropped (0 takes no value bytes). Readers skip tags
+ * they do not know and treat missing tags as "keep the default", so fields
+ * can be added or widened without bumping the section version.
+ */
+
+/* Largest encoded field for a 32-bit value */
+#define TLV_FIELD_MAX_BYTES (2 + sizeof(uint32_t))
+
+struct tlv_field {
+    uint8_t tag;
+    uint8_t len;
+    const uint8_t *value;
+};
+
+/**
+ * @brief Append a 32-bit field
+ *
+ * @return Number of bytes written, 0 if it did not fit
+ */
+static inline size_t tlv_put_u32(uint8_t *buf, size_t size, uint8_t tag, uint32_t value) {
+    uint8_t len = 0;
+
+    for (uint32_t v = value; v != 0; v >>= 8) {
+        len++;
+    }
+
+    if (size < 2U + len) {
+        return 0;
+    }
+
+    buf[0] = tag;
+    buf[1] = len;
+    for (uint8_t i = 0; i < len; i++) {
+        buf[2 + i] = (uint8_t)(value >> (8 * i));
+    }
+
+    return 2U + len;
+}
+
+/**
+ * @brief Read the field at *pos and advance past it
+ *
+ * @return 1 if a field was read, 0 at the end of the buffer, -EINVAL if the
+ *         field is truncated
+ */
+static inline int tlv_next(const uint8_t *buf, size_t size, size_t *pos, struct tlv_field *field) {
+    if (*pos >= size) {
+        return 0;
+    }
+
+    if (size - *pos < 2 || size - *pos - 2 < buf[*pos + 1]) {
+        return -EINVAL;
+    }
+
+    field->tag = buf[*pos];
+    field->len = buf[*pos + 1];
+    field->value = &buf[*pos + 2];
+    *pos += 2U + field->len;
+
+    return 1;
+}
+
+/**
+ * @brief Value of a field as a 32-bit integer
+ *
+ * Bytes above the low 32 bits (a field widened by a newer version) are
+ * ignored.
+ */
+static inline uint32_t tlv_get_u32(const struct tlv_field *field) {
+    uint32_t value = 0;
+
+    for (uint8_t i = 0; i < field->len && i < sizeof(uint32_t); i++) {
+        value |= (uint32_t)field->value[i] << (8 * i);
+    }
+
+    return value;
+}
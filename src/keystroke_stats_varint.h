@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @file keystroke_stats_varint.h
+ * @brief LEB128 varint helpers for compact persisted records
+ *
+ * Unsigned 32-bit values take 1-5 bytes, 7 bits per byte, least significant
+ * group first. Signed values are zigzag mapped first.
+ */
+
+#define VARINT_MAX_BYTES 5
+
+/**
+ * @brief Encode a varint
+ *
+ * @return Number of bytes written, 0 if it did not fit
+ */
+static inline size_t varint_encode(uint32_t value, uint8_t *buf, size_t size) {
+    size_t len = 0;
+
+    do {
+        if (len >= size) {
+            return 0;
+        }
+        uint8_t byte = value & 0x7f;
+        value >>= 7;
+        buf[len++] = byte | (value ? 0x80 : 0);
+    } while (value);
+
+    return len;
+}
+
+/**
+ * @brief Decode a varint
+ *
+ * @return Number of bytes consumed, 0 if truncated or too long
+ */
+static inline size_t varint_decode(const uint8_t *buf, size_t size, uint32_t *value) {
+    uint32_t result = 0;
+
+    for (size_t i = 0; i < size && i < VARINT_MAX_BYTES; i++) {
+        result |= (uint32_t)(buf[i] & 0x7f) << (7 * i);
+        if (!(buf[i] & 0x80)) {
+            *value = result;
+            return i + 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Map a signed value to unsigned so small magnitudes encode short
+ *
+ * 0, -1, 1, -2, 2 ... become 0, 1, 2, 3, 4 ...
+ */
+static inline uint32_t zigzag_encode(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static inline int32_t zigzag_decode(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
@@ -8,6 +8,7 @@
 #include <zephyr/device.h>
 #include <zephyr/logging/log.h>
 #include <zmk/keystroke_stats.h>
+#include <string.h>
 
 LOG_MODULE_REGISTER(keystroke_stats_headless, CONFIG_ZMK_KEYSTROKE_STATS_LOG_LEVEL);
 
@@ -19,55 +20,211 @@ LOG_MODULE_REGISTER(keystroke_stats_headless, CONFIG_ZMK_KEYSTROKE_STATS_LOG_LEV
  * - Testing the core statistics engine without display hardware
  * - Debugging via UART/RTT logs
  * - Headless keyboard builds that access stats via other means
+ *
+ * The subscription's minimum interval holds notifications back to one per
+ * log interval, and the callback, which runs in the keystroke listener,
+ * only submits a log work item. The work item logs a single line with the
+ * fields that changed since the previous line; a burst of typing costs one
+ * log message, idle time costs none.
  */
 
-static void stats_callback(const struct zmk_keystroke_stats *stats, void *user_data) {
-    ARG_UNUSED(user_data);
+/* Values as of the last logged line */
+struct logged_stats {
+    uint32_t today;
+    uint32_t yesterday;
+    uint32_t total;
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_SESSION_TRACKING
+    uint32_t session;
+#endif
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_WPM
+    uint8_t wpm;
+    uint8_t peak_wpm;
+#endif
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_KEY_HEATMAP
+    uint32_t top_position;
+#endif
+};
 
-    /* Log statistics periodically */
-    LOG_INF("=== Keystroke Statistics ===");
-    LOG_INF("Today: %u, Yesterday: %u, Total: %u",
-            stats->today_keystrokes,
-            stats->yesterday_keystrokes,
-            stats->total_keystrokes);
+static struct logged_stats last;
+static bool logged_once;
 
+static void log_work_handler(struct k_work *work);
+static K_WORK_DEFINE(log_work, log_work_handler);
+
+static void fill_logged(struct logged_stats *out, const struct zmk_keystroke_stats *stats) {
+    memset(out, 0, sizeof(*out));
+    out->today = stats->today_keystrokes;
+    out->yesterday = stats->yesterday_keystrokes;
+    out->total = stats->total_keystrokes;
 #if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_SESSION_TRACKING
-    LOG_INF("Session: %u keystrokes", stats->session_keystrokes);
+    out->session = stats->session_keystrokes;
+#endif
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_WPM
+    out->wpm = stats->current_wpm;
+    out->peak_wpm = stats->peak_wpm;
+#endif
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_KEY_HEATMAP
+    /* Top keys are sorted, the first is the most pressed */
+    out->top_position = stats->top_keys[0].count > 0 ? stats->top_keys[0].position : UINT32_MAX;
 #endif
+}
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_HEADLESS_LOG_COMPACT
 
+/**
+ * @brief Log every field in one fixed, integer-only format
+ *
+ * A constant format string with integer arguments is what dictionary
+ * logging stores as a few binary words, so this stays cheap enough to
+ * leave on in production. Fields of disabled features are logged as 0.
+ */
+static void log_stats(const struct logged_stats *now) {
+    uint32_t session = 0, wpm = 0, peak_wpm = 0, top_position = UINT32_MAX;
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_SESSION_TRACKING
+    session = now->session;
+#endif
 #if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_WPM
-    LOG_INF("WPM - Current: %u, Average: %u, Peak: %u",
-            stats->current_wpm,
-            stats->average_wpm,
-            stats->peak_wpm);
+    wpm = now->wpm;
+    peak_wpm = now->peak_wpm;
 #endif
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_KEY_HEATMAP
+    top_position = now->top_position;
+#endif
+
+    LOG_INF("kstats %u %u %u %u %u %u %d", now->today, now->yesterday, now->total, session, wpm,
+            peak_wpm, top_position == UINT32_MAX ? -1 : (int)top_position);
+}
+
+#else
+
+#define LINE_SIZE 128
+
+/**
+ * @brief Append a string, keeping the line NUL-terminated
+ */
+static size_t append(char *line, size_t len, const char *text) {
+    size_t n = MIN(strlen(text), LINE_SIZE - 1 - len);
+
+    memcpy(&line[len], text, n);
+    line[len + n] = '\0';
+
+    return len + n;
+}
+
+/**
+ * @brief Append " name value" and, after the first line, the increase
+ */
+static size_t append_count(char *line, size_t len, const char *name, uint32_t value,
+                           uint32_t prev) {
+    char buf[ZMK_KEYSTROKE_STATS_COUNT_STR_LEN];
+
+    len = append(line, len, len > 0 ? ", " : "");
+    len = append(line, len, name);
+    len = append(line, len, " ");
+    zmk_keystroke_stats_format_count(value, buf, sizeof(buf));
+    len = append(line, len, buf);
+
+    if (logged_once && value > prev) {
+        len = append(line, len, " (+");
+        zmk_keystroke_stats_format_count(value - prev, buf, sizeof(buf));
+        len = append(line, len, buf);
+        len = append(line, len, ")");
+    }
+
+    return len;
+}
+
+/**
+ * @brief Log the fields that changed since the last line, all on the first
+ */
+static void log_stats(const struct logged_stats *now) {
+    char line[LINE_SIZE] = "";
+    size_t len = 0;
 
+    if (!logged_once || now->today != last.today) {
+        len = append_count(line, len, "today", now->today, last.today);
+    }
+    if (!logged_once || now->yesterday != last.yesterday) {
+        len = append_count(line, len, "yesterday", now->yesterday, last.yesterday);
+    }
+    if (!logged_once || now->total != last.total) {
+        len = append_count(line, len, "total", now->total, last.total);
+    }
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_SESSION_TRACKING
+    if (!logged_once || now->session != last.session) {
+        len = append_count(line, len, "session", now->session, last.session);
+    }
+#endif
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_WPM
+    if (!logged_once || now->wpm != last.wpm || now->peak_wpm != last.peak_wpm) {
+        /* Rates, an increase would not mean anything */
+        len = append_count(line, len, "wpm", now->wpm, UINT32_MAX);
+        len = append_count(line, len, "peak", now->peak_wpm, UINT32_MAX);
+    }
+#endif
 #if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_KEY_HEATMAP
-    LOG_INF("Top 3 keys:");
-    for (int i = 0; i < 3 && i < CONFIG_ZMK_KEYSTROKE_STATS_TOP_KEYS_COUNT; i++) {
-        if (stats->top_keys[i].count > 0) {
-            LOG_INF("  #%d: Position %u = %u presses",
-                    i + 1,
-                    stats->top_keys[i].position,
-                    stats->top_keys[i].count);
-        }
+    if (now->top_position != UINT32_MAX && now->top_position != last.top_position) {
+        len = append_count(line, len, "top key", now->top_position, UINT32_MAX);
     }
 #endif
 
-    LOG_INF("===========================");
+    if (len > 0) {
+        LOG_INF("Keystrokes: %s", line);
+    }
 }
 
+#endif /* CONFIG_ZMK_KEYSTROKE_STATS_HEADLESS_LOG_COMPACT */
+
+static void log_work_handler(struct k_work *work) {
+    ARG_UNUSED(work);
+
+    struct zmk_keystroke_stats stats;
+    struct logged_stats now;
+
+    if (zmk_keystroke_stats_get(&stats) < 0) {
+        return;
+    }
+
+    fill_logged(&now, &stats);
+    if (logged_once && memcmp(&now, &last, sizeof(now)) == 0) {
+        return;
+    }
+
+    log_stats(&now);
+    /* memcpy keeps the zeroed padding that the memcmp above relies on */
+    memcpy(&last, &now, sizeof(last));
+    logged_once = true;
+}
+
+static void stats_callback(const struct zmk_keystroke_stats *stats, void *user_data) {
+    ARG_UNUSED(stats);
+    ARG_UNUSED(user_data);
+
+    k_work_submit(&log_work);
+}
+
+/* Top key changes come with a total change, the log work reads them itself */
+static struct zmk_keystroke_stats_subscriber subscriber = {
+    .callback = stats_callback,
+    .interest = ZMK_KEYSTROKE_STATS_CHANGED_TODAY | ZMK_KEYSTROKE_STATS_CHANGED_YESTERDAY |
+                ZMK_KEYSTROKE_STATS_CHANGED_TOTAL | ZMK_KEYSTROKE_STATS_CHANGED_SESSION |
+                ZMK_KEYSTROKE_STATS_CHANGED_WPM,
+    .min_interval_ms = CONFIG_ZMK_KEYSTROKE_STATS_HEADLESS_LOG_INTERVAL_MS,
+};
+
 static int headless_ui_init(void) {
     LOG_INF("Initializing headless UI (logging only)");
 
-    /* Register callback for statistics updates */
-    int ret = zmk_keystroke_stats_register_callback(stats_callback, NULL);
+    /* Subscribe to statistics updates */
+    int ret = zmk_keystroke_stats_subscribe(&subscriber);
     if (ret < 0) {
-        LOG_ERR("Failed to register callback: %d", ret);
+        LOG_ERR("Failed to subscribe: %d", ret);
         return ret;
     }
 
-    LOG_INF("Headless UI initialized - statistics will be logged");
+    LOG_INF("Headless UI initialized - statistics logged at most every %d ms",
+            CONFIG_ZMK_KEYSTROKE_STATS_HEADLESS_LOG_INTERVAL_MS);
 
     return 0;
 }
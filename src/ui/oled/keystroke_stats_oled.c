@@ -8,82 +8,354 @@
 #include <zephyr/logging/log.h>
 #include <zephyr/device.h>
 #include <zephyr/drivers/display.h>
+#include <zephyr/sys/atomic.h>
 #include <zmk/keystroke_stats.h>
+#include <zmk/event_manager.h>
+#include <zmk/activity.h>
+#include <zmk/events/activity_state_changed.h>
+#include <string.h>
 
 LOG_MODULE_REGISTER(keystroke_stats_oled, CONFIG_ZMK_KEYSTROKE_STATS_LOG_LEVEL);
 
 /**
  * @brief OLED SSD1306 UI implementation
  *
- * This file provides a placeholder for the OLED display implementation.
- * Full implementation will include:
- * - SSD1306 display driver integration (128x64px monochrome)
- * - Text rendering with built-in fonts
- * - Vertical layout for statistics display:
- *   Line 1: "TODAY: 1234"
- *   Line 2: "YESTERDAY: 987"
- *   Line 3: "TOTAL: 12.3K"
- *   Line 4: "WPM: 45" (if enabled)
- * - Power-efficient updates (2-second interval default)
+ * Renders into a RAM framebuffer in the SSD1306 layout (128 columns by 8
+ * pages, one byte per column and page, LSB at the top) and pushes it with
+ * display_write() on the zephyr,display chosen node:
+ *   TODAY        1234
+ *   YESTERDAY     987
+ *   TOTAL       12.3K
+ *   WPM            45   (if enabled)
  *
- * TODO: Full implementation pending OLED hardware testing
+ * Each row is one 8-pixel page. A row is rendered into a scratch page and
+ * compared with the framebuffer; only pages that changed are written, so
+ * a keystroke usually costs two 128-byte I2C writes instead of 1 KB.
+ *
+ * 128x32 panels show the rows on consecutive pages, 128x64 panels leave a
+ * blank page between rows. The display must not also be driven by ZMK's
+ * own LVGL status screen.
  */
 
 #if CONFIG_DISPLAY
 
+#define OLED_WIDTH 128
+#define OLED_PAGES 8
+#define PAGE_HEIGHT 8
+
+#define GLYPH_WIDTH 5
+#define CELL_WIDTH (GLYPH_WIDTH + 1)
+
+/*
+ * 5x7 glyphs, column-major: one byte per column, bit 0 is the top row.
+ * Only the characters the rows can contain; anything else renders blank.
+ */
+static const char glyph_chars[] = "0123456789.:ADEGKLMOPRSTWY";
+static const uint8_t glyphs[][GLYPH_WIDTH] = {
+    {0x3e, 0x51, 0x49, 0x45, 0x3e}, /* 0 */
+    {0x00, 0x42, 0x7f, 0x40, 0x00}, /* 1 */
+    {0x42, 0x61, 0x51, 0x49, 0x46}, /* 2 */
+    {0x21, 0x41, 0x45, 0x4b, 0x31}, /* 3 */
+    {0x18, 0x14, 0x12, 0x7f, 0x10}, /* 4 */
+    {0x27, 0x45, 0x45, 0x45, 0x39}, /* 5 */
+    {0x3c, 0x4a, 0x49, 0x49, 0x30}, /* 6 */
+    {0x01, 0x71, 0x09, 0x05, 0x03}, /* 7 */
+    {0x36, 0x49, 0x49, 0x49, 0x36}, /* 8 */
+    {0x06, 0x49, 0x49, 0x29, 0x1e}, /* 9 */
+    {0x00, 0x60, 0x60, 0x00, 0x00}, /* . */
+    {0x00, 0x36, 0x36, 0x00, 0x00}, /* : */
+    {0x7e, 0x11, 0x11, 0x11, 0x7e}, /* A */
+    {0x7f, 0x41, 0x41, 0x22, 0x1c}, /* D */
+    {0x7f, 0x49, 0x49, 0x49, 0x41}, /* E */
+    {0x3e, 0x41, 0x49, 0x49, 0x7a}, /* G */
+    {0x7f, 0x08, 0x14, 0x22, 0x41}, /* K */
+    {0x7f, 0x40, 0x40, 0x40, 0x40}, /* L */
+    {0x7f, 0x02, 0x0c, 0x02, 0x7f}, /* M */
+    {0x3e, 0x41, 0x41, 0x41, 0x3e}, /* O */
+    {0x7f, 0x09, 0x09, 0x09, 0x06}, /* P */
+    {0x7f, 0x09, 0x19, 0x29, 0x46}, /* R */
+    {0x46, 0x49, 0x49, 0x49, 0x31}, /* S */
+    {0x01, 0x01, 0x7f, 0x01, 0x01}, /* T */
+    {0x3f, 0x40, 0x38, 0x40, 0x3f}, /* W */
+    {0x07, 0x08, 0x70, 0x08, 0x07}, /* Y */
+};
+
+BUILD_ASSERT(ARRAY_SIZE(glyphs) == sizeof(glyph_chars) - 1, "One glyph per character");
+
 static const struct device *display_dev = NULL;
-static struct k_timer update_timer;
+static struct k_work_delayable update_work;
 
-static void update_display(const struct zmk_keystroke_stats *stats, void *user_data) {
-    ARG_UNUSED(user_data);
+/* Set by the statistics callback, cleared when the change is rendered */
+static atomic_t stats_changed;
+
+static uint8_t framebuffer[OLED_PAGES][OLED_WIDTH];
+static uint8_t dirty_pages;
+
+/* Panel geometry in use, at most OLED_WIDTH x OLED_PAGES */
+static uint16_t width;
+static uint8_t pages;
+
+/* Panel shows set bits dark (MONO10), so pages are inverted on the way out */
+static bool invert;
+
+/* Pages written and skipped as unchanged, bytes pushed to the panel */
+static uint32_t pages_written;
+static uint32_t pages_skipped;
+static uint32_t bytes_pushed;
+
+static const uint8_t *find_glyph(char c) {
+    const char *p = strchr(glyph_chars, c);
+
+    return (c != '\0' && p != NULL) ? glyphs[p - glyph_chars] : NULL;
+}
+
+/**
+ * @brief Draw text into a page, clipped at the panel width
+ */
+static void draw_text(uint8_t *page, int x, const char *text) {
+    for (; *text != '\0'; text++, x += CELL_WIDTH) {
+        const uint8_t *glyph = find_glyph(*text);
+
+        if (glyph == NULL) {
+            continue;
+        }
+
+        for (int col = 0; col < GLYPH_WIDTH; col++) {
+            if (x + col >= 0 && x + col < width) {
+                page[x + col] = glyph[col];
+            }
+        }
+    }
+}
+
+/**
+ * @brief Render a label and right-aligned value into a page
+ *
+ * The page is only marked dirty if its content actually changed.
+ */
+static void render_row(uint8_t page, const char *label, uint32_t value) {
+    uint8_t scratch[OLED_WIDTH] = {0};
+    char buf[ZMK_KEYSTROKE_STATS_COUNT_STR_LEN];
+
+    /* Padded to a fixed width, so every value starts at the same column */
+    zmk_keystroke_stats_format_count_padded(value, buf, sizeof(buf),
+                                            ZMK_KEYSTROKE_STATS_COUNT_WIDTH);
+
+    draw_text(scratch, 0, label);
+    /* The last cell's spacing column is not needed at the right edge */
+    draw_text(scratch, width - ZMK_KEYSTROKE_STATS_COUNT_WIDTH * CELL_WIDTH + 1, buf);
+
+    if (memcmp(scratch, framebuffer[page], width) != 0) {
+        memcpy(framebuffer[page], scratch, width);
+        dirty_pages |= BIT(page);
+    }
+}
+
+/**
+ * @brief Write dirty pages to the panel
+ */
+static void flush_pages(void) {
+    static uint8_t inverted[OLED_WIDTH];
+    const struct display_buffer_descriptor desc = {
+        .buf_size = width,
+        .width = width,
+        .height = PAGE_HEIGHT,
+        .pitch = width,
+    };
+
+    for (uint8_t page = 0; page < pages; page++) {
+        const uint8_t *data = framebuffer[page];
+
+        if (!(dirty_pages & BIT(page))) {
+            pages_skipped++;
+            continue;
+        }
+
+        if (invert) {
+            for (uint16_t i = 0; i < width; i++) {
+                inverted[i] = ~framebuffer[page][i];
+            }
+            data = inverted;
+        }
+
+        int ret = display_write(display_dev, 0, page * PAGE_HEIGHT, &desc, data);
+        if (ret < 0) {
+            /* Stays dirty and is retried on the next update */
+            LOG_ERR("Failed to write page %u: %d", page, ret);
+            continue;
+        }
+
+        dirty_pages &= ~BIT(page);
+        pages_written++;
+        bytes_pushed += width;
+    }
+}
+
+static void update_display(const struct zmk_keystroke_stats *stats) {
+    /* Spread the rows over the panel: every page on 128x32, every other on 128x64 */
+    const uint8_t pitch = MAX(pages / 4, 1);
+    uint8_t page = 0;
 
-    if (display_dev == NULL) {
-        return;
+    render_row(page, "TODAY", stats->today_keystrokes);
+    page += pitch;
+    if (page < pages) {
+        render_row(page, "YESTERDAY", stats->yesterday_keystrokes);
     }
+    page += pitch;
+    if (page < pages) {
+        render_row(page, "TOTAL", stats->total_keystrokes);
+    }
+#if CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_WPM
+    page += pitch;
+    if (page < pages) {
+        render_row(page, "WPM", stats->current_wpm);
+    }
+#endif
 
-    /* TODO: Clear display buffer */
-    /* TODO: Render statistics text */
-    /* TODO: Push buffer to display */
+    flush_pages();
 
-    LOG_DBG("OLED UI updated: Today=%u, Yesterday=%u, Total=%u",
+    LOG_DBG("OLED UI updated: Today=%u, Yesterday=%u, Total=%u "
+            "(%u pages written, %u skipped, %u bytes pushed)",
             stats->today_keystrokes,
             stats->yesterday_keystrokes,
-            stats->total_keystrokes);
+            stats->total_keystrokes,
+            pages_written, pages_skipped, bytes_pushed);
+}
+
+/**
+ * @brief Statistics callback
+ *
+ * Runs in the keystroke listener and holds up the next keystroke, so it
+ * only flags the change; rendering and I2C happen in the update work.
+ */
+static void stats_callback(const struct zmk_keystroke_stats *stats, void *user_data) {
+    ARG_UNUSED(stats);
+    ARG_UNUSED(user_data);
+
+    atomic_set(&stats_changed, 1);
+}
+
+static struct zmk_keystroke_stats_subscriber subscriber = {
+    .callback = stats_callback,
+    .interest = ZMK_KEYSTROKE_STATS_CHANGED_TODAY | ZMK_KEYSTROKE_STATS_CHANGED_YESTERDAY |
+                ZMK_KEYSTROKE_STATS_CHANGED_TOTAL |
+                (IS_ENABLED(CONFIG_ZMK_KEYSTROKE_STATS_ENABLE_WPM) ? ZMK_KEYSTROKE_STATS_CHANGED_WPM
+                                                                   : 0),
+};
+
+/*
+ * Nothing changes while the keyboard is idle or asleep, so the update
+ * work is not rescheduled then; activity restarts it with an immediate
+ * update.
+ */
+static bool suspended;
+
+static void update_work_handler(struct k_work *work) {
+    ARG_UNUSED(work);
+
+    /* Pages that failed to write are retried even without a change */
+    if (atomic_set(&stats_changed, 0) || dirty_pages != 0) {
+        struct zmk_keystroke_stats stats;
+        if (zmk_keystroke_stats_get(&stats) == 0) {
+            update_display(&stats);
+        }
+    }
+
+    if (!suspended) {
+        k_work_schedule(&update_work,
+                        K_MSEC(CONFIG_ZMK_KEYSTROKE_STATS_OLED_UPDATE_INTERVAL_MS));
+    }
+}
+
+static int activity_listener(const zmk_event_t *eh) {
+    const struct zmk_activity_state_changed *ev = as_zmk_activity_state_changed(eh);
+
+    /* Not set up (no display), or already in that state */
+    if (ev == NULL || display_dev == NULL ||
+        suspended == (ev->state != ZMK_ACTIVITY_ACTIVE)) {
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+
+    suspended = ev->state != ZMK_ACTIVITY_ACTIVE;
+    if (suspended) {
+        k_work_cancel_delayable(&update_work);
+    } else {
+        k_work_reschedule(&update_work, K_NO_WAIT);
+    }
+
+    LOG_DBG("OLED updates %s", suspended ? "suspended" : "resumed");
+
+    return ZMK_EV_EVENT_BUBBLE;
 }
 
-static void timer_handler(struct k_timer *timer) {
-    ARG_UNUSED(timer);
+ZMK_LISTENER(keystroke_stats_oled, activity_listener);
+ZMK_SUBSCRIPTION(keystroke_stats_oled, zmk_activity_state_changed);
 
-    /* Get current stats and update display */
-    struct zmk_keystroke_stats stats;
-    if (zmk_keystroke_stats_get(&stats) == 0) {
-        update_display(&stats, NULL);
+/**
+ * @brief Check the panel layout and set up the pixel format
+ */
+static int setup_display(void) {
+    struct display_capabilities caps;
+
+    display_get_capabilities(display_dev, &caps);
+
+    if (!(caps.screen_info & SCREEN_INFO_MONO_VTILED) ||
+        (caps.screen_info & SCREEN_INFO_MONO_MSB_FIRST)) {
+        LOG_ERR("Display is not an SSD1306-style vertically tiled panel");
+        return -ENOTSUP;
     }
+
+    if (caps.x_resolution < 64 || caps.y_resolution < PAGE_HEIGHT) {
+        LOG_ERR("Display too small (%ux%u)", caps.x_resolution, caps.y_resolution);
+        return -ENOTSUP;
+    }
+
+    width = MIN(caps.x_resolution, OLED_WIDTH);
+    pages = MIN(caps.y_resolution / PAGE_HEIGHT, OLED_PAGES);
+
+    if (caps.current_pixel_format != PIXEL_FORMAT_MONO01 &&
+        display_set_pixel_format(display_dev, PIXEL_FORMAT_MONO01) < 0) {
+        invert = true;
+    }
+
+    return display_blanking_off(display_dev);
 }
 
 static int oled_ui_init(void) {
     LOG_INF("Initializing OLED UI");
 
-    /* TODO: Get display device */
-    /* display_dev = DEVICE_DT_GET(...); */
+#if DT_HAS_CHOSEN(zephyr_display)
+    display_dev = DEVICE_DT_GET(DT_CHOSEN(zephyr_display));
+#endif
+    if (display_dev == NULL || !device_is_ready(display_dev)) {
+        LOG_ERR("Display device not ready");
+        display_dev = NULL;
+        return -ENODEV;
+    }
+
+    int ret = setup_display();
+    if (ret < 0) {
+        LOG_ERR("Failed to set up display: %d", ret);
+        return ret;
+    }
 
-    /* TODO: Initialize display */
-    /* TODO: Clear display */
+    /* Clear the whole panel once, later updates only touch changed pages */
+    memset(framebuffer, 0, sizeof(framebuffer));
+    dirty_pages = BIT_MASK(pages);
 
-    /* Register callback */
-    int ret = zmk_keystroke_stats_register_callback(update_display, NULL);
+    /* Subscribe to the fields shown */
+    ret = zmk_keystroke_stats_subscribe(&subscriber);
     if (ret < 0) {
-        LOG_ERR("Failed to register callback: %d", ret);
+        LOG_ERR("Failed to subscribe: %d", ret);
         return ret;
     }
 
-    /* Start periodic update timer */
-    k_timer_init(&update_timer, timer_handler, NULL);
-    k_timer_start(&update_timer,
-                  K_MSEC(CONFIG_ZMK_KEYSTROKE_STATS_OLED_UPDATE_INTERVAL_MS),
-                  K_MSEC(CONFIG_ZMK_KEYSTROKE_STATS_OLED_UPDATE_INTERVAL_MS));
+    /* Render right away, the statistics may still be loading */
+    atomic_set(&stats_changed, 1);
+    k_work_init_delayable(&update_work, update_work_handler);
+    k_work_schedule(&update_work, K_NO_WAIT);
 
-    LOG_WRN("OLED UI initialized (PLACEHOLDER - full implementation pending)");
+    LOG_INF("OLED UI initialized (%ux%u)", width, pages * PAGE_HEIGHT);
 
     return 0;
 }
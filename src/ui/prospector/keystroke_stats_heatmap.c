@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/logging/log.h>
+#include <zmk/keystroke_stats.h>
+#include <zmk/physical_layouts.h>
+#include <lvgl.h>
+
+#include "keystroke_stats_prospector.h"
+
+LOG_MODULE_REGISTER(keystroke_stats_heatmap, CONFIG_ZMK_KEYSTROKE_STATS_LOG_LEVEL);
+
+/*
+ * Key heatmap drawn from the selected physical layout. Each key is a
+ * rectangle colored by its press count on a log scale relative to the
+ * most pressed key, quantized into HEATMAP_BUCKETS colors looked up in a
+ * table built once.
+ *
+ * There is no canvas buffer: the widget draws the cells in its draw event,
+ * and an update only invalidates the cells whose bucket changed, so LVGL
+ * re-renders (and sends to the display) just those small areas. A single
+ * keystroke changes at most one bucket unless it raises the maximum.
+ *
+ * Rotated keys are drawn as their unrotated rectangle.
+ */
+
+#define HEATMAP_BUCKETS 8
+
+/* Bucket 0 is reserved for keys never pressed, the rest go cold to hot */
+#define COLOR_UNUSED 0x303030
+#define COLOR_COLD 0x1a2a4a
+#define COLOR_HOT 0xff3020
+
+static lv_color_t color_lut[HEATMAP_BUCKETS];
+
+static lv_obj_t *heatmap = NULL;
+
+/* Cell of each key relative to the widget, and its current bucket */
+static lv_area_t cells[CONFIG_ZMK_KEYSTROKE_STATS_MAX_KEY_POSITIONS];
+static uint8_t buckets[CONFIG_ZMK_KEYSTROKE_STATS_MAX_KEY_POSITIONS];
+
+/* Key counts read by an update, static to keep them off the display stack */
+static uint32_t counts[CONFIG_ZMK_KEYSTROKE_STATS_MAX_KEY_POSITIONS];
+static size_t cell_count;
+
+/* Cells invalidated since boot */
+static uint32_t cells_invalidated;
+
+static void build_color_lut(void) {
+    lv_color_t cold = lv_color_hex(COLOR_COLD);
+    lv_color_t hot = lv_color_hex(COLOR_HOT);
+
+    color_lut[0] = lv_color_hex(COLOR_UNUSED);
+    for (int i = 1; i < HEATMAP_BUCKETS; i++) {
+        /* lv_color_mix weighs the first color by mix/255 */
+        color_lut[i] = lv_color_mix(hot, cold, (i - 1) * 255 / (HEATMAP_BUCKETS - 2));
+    }
+}
+
+/**
+ * @brief Log-scaled bucket of a count, relative to the largest count
+ */
+static uint8_t count_bucket(uint32_t count, uint32_t max) {
+    if (count == 0 || max == 0) {
+        return 0;
+    }
+
+    /* Bit lengths are integer log2 + 1, so 1 press is already above bucket 0 */
+    uint32_t bits = find_msb_set(count);
+    uint32_t max_bits = find_msb_set(max);
+    uint32_t bucket = 1 + (bits - 1) * (HEATMAP_BUCKETS - 2) / MAX(max_bits - 1, 1);
+
+    return MIN(bucket, HEATMAP_BUCKETS - 1);
+}
+
+static void draw_event_cb(lv_event_t *e) {
+    lv_obj_t *obj = lv_event_get_target(e);
+    lv_draw_ctx_t *draw_ctx = lv_event_get_draw_ctx(e);
+    lv_draw_rect_dsc_t dsc;
+    lv_area_t coords;
+
+    lv_obj_get_coords(obj, &coords);
+    lv_draw_rect_dsc_init(&dsc);
+    dsc.radius = 2;
+
+    for (size_t i = 0; i < cell_count; i++) {
+        lv_area_t area = cells[i];
+
+        lv_area_move(&area, coords.x1, coords.y1);
+
+        /* Only the invalidated cells are inside the clip area */
+        if (!_lv_area_is_on(&area, draw_ctx->clip_area)) {
+            continue;
+        }
+
+        dsc.bg_color = color_lut[buckets[i]];
+        lv_draw_rect(draw_ctx, &dsc, &area);
+    }
+}
+
+/**
+ * @brief Scale the physical layout into the widget
+ *
+ * Layout coordinates are in hundredths of a key unit. The layout keeps its
+ * aspect ratio and is centered.
+ */
+static int build_cells(lv_coord_t width, lv_coord_t height) {
+#if DT_HAS_COMPAT_STATUS_OKAY(zmk_physical_layout)
+    const struct zmk_physical_layout *const *layouts;
+    int count = zmk_physical_layouts_get_list(&layouts);
+    int selected = zmk_physical_layouts_get_selected();
+
+    if (count <= 0 || selected < 0 || selected >= count) {
+        return -ENODEV;
+    }
+
+    const struct zmk_physical_layout *layout = layouts[selected];
+    int32_t min_x = INT16_MAX, min_y = INT16_MAX, max_x = INT16_MIN, max_y = INT16_MIN;
+
+    cell_count = MIN(layout->keys_len, ARRAY_SIZE(cells));
+    if (cell_count < layout->keys_len) {
+        LOG_WRN("Layout has %zu keys, showing the first %zu", layout->keys_len, cell_count);
+    }
+
+    for (size_t i = 0; i < cell_count; i++) {
+        const struct zmk_key_physical_attrs *key = &layout->keys[i];
+
+        min_x = MIN(min_x, key->x);
+        min_y = MIN(min_y, key->y);
+        max_x = MAX(max_x, key->x + key->width);
+        max_y = MAX(max_y, key->y + key->height);
+    }
+
+    int32_t span_x = MAX(max_x - min_x, 1);
+    int32_t span_y = MAX(max_y - min_y, 1);
+
+    /* Common scale as a fraction: pixels per layout unit = num / den */
+    int32_t num = width;
+    int32_t den = span_x;
+    if ((int64_t)height * span_x < (int64_t)width * span_y) {
+        num = height;
+        den = span_y;
+    }
+
+    int32_t off_x = (width - span_x * num / den) / 2;
+    int32_t off_y = (height - span_y * num / den) / 2;
+
+    for (size_t i = 0; i < cell_count; i++) {
+        const struct zmk_key_physical_attrs *key = &layout->keys[i];
+
+        /* One pixel gap between neighbouring keys */
+        cells[i].x1 = off_x + (key->x - min_x) * num / den;
+        cells[i].y1 = off_y + (key->y - min_y) * num / den;
+        cells[i].x2 = off_x + (key->x - min_x + key->width) * num / den - 2;
+        cells[i].y2 = off_y + (key->y - min_y + key->height) * num / den - 2;
+    }
+
+    return 0;
+#else
+    ARG_UNUSED(width);
+    ARG_UNUSED(height);
+    return -ENODEV;
+#endif
+}
+
+lv_obj_t *keystroke_stats_heatmap_create(lv_obj_t *parent, lv_coord_t width, lv_coord_t height) {
+    int ret = build_cells(width, height);
+    if (ret < 0) {
+        LOG_ERR("No physical layout for the heatmap: %d", ret);
+        return NULL;
+    }
+
+    build_color_lut();
+
+    heatmap = lv_obj_create(parent);
+    lv_obj_set_size(heatmap, width, height);
+    lv_obj_set_style_bg_opa(heatmap, LV_OPA_TRANSP, LV_PART_MAIN);
+    lv_obj_set_style_border_width(heatmap, 0, LV_PART_MAIN);
+    lv_obj_set_style_pad_all(heatmap, 0, LV_PART_MAIN);
+    lv_obj_add_event_cb(heatmap, draw_event_cb, LV_EVENT_DRAW_MAIN, NULL);
+
+    LOG_INF("Heatmap created with %zu keys", cell_count);
+
+    return heatmap;
+}
+
+void keystroke_stats_heatmap_update(void) {
+    lv_area_t coords;
+    uint32_t max_count = 0;
+    uint32_t changed = 0;
+
+    if (heatmap == NULL) {
+        return;
+    }
+
+    /*
+     * The maximum is found here rather than taken from the top keys, which
+     * the statistics engine would have to sort in the keystroke listener.
+     */
+    for (size_t i = 0; i < cell_count; i++) {
+        if (zmk_keystroke_stats_get_key_count(i, &counts[i]) < 0) {
+            counts[i] = 0;
+        }
+        max_count = MAX(max_count, counts[i]);
+    }
+
+    lv_obj_get_coords(heatmap, &coords);
+
+    for (size_t i = 0; i < cell_count; i++) {
+        uint8_t bucket = count_bucket(counts[i], max_count);
+        if (bucket == buckets[i]) {
+            continue;
+        }
+
+        lv_area_t area = cells[i];
+
+        buckets[i] = bucket;
+        lv_area_move(&area, coords.x1, coords.y1);
+        lv_obj_invalidate_area(heatmap, &area);
+        changed++;
+    }
+
+    cells_invalidated += changed;
+    if (changed > 0) {
+        LOG_DBG("Heatmap: %u cells invalidated (%u total)", changed, cells_invalidated);
+    }
+}
@@ -8,11 +8,14 @@
 #include <zephyr/device.h>
 #include <zephyr/logging/log.h>
 #include <zmk/keystroke_stats.h>
-#include <stdio.h>
+#include <string.h>
 
 #if CONFIG_LVGL
 #include <lvgl.h>
 #include <prospector_screen.h>
+#include <zmk/display.h>
+
+#include "keystroke_stats_prospector.h"
 #endif
 
 LOG_MODULE_REGISTER(keystroke_stats_prospector, CONFIG_ZMK_KEYSTROKE_STATS_LOG_LEVEL);
@@ -25,6 +28,18 @@ LOG_MODULE_REGISTER(keystroke_stats_prospector, CONFIG_ZMK_KEYSTROKE_STATS_LOG_L
  * - Font: FRAC_Regular_32 for numbers, FoundryGridnikMedium_20 for labels
  * - Colors: TODAY in cyan (#00ffe5), others in white
  * - Number formatting: Hybrid (0-9999 as-is, 10K+ as "12.3K")
+ * - Only labels whose text changed are touched: setting a label's text
+ *   invalidates its area, and every redraw is an SPI transfer to the
+ *   ST7789V even when the pixels end up the same
+ *
+ * Statistics callbacks run in the keystroke listener, and LVGL may only be
+ * used from the display thread. The callback therefore just posts a
+ * snapshot of the displayed values to a mailbox, and an LVGL timer on the
+ * display thread applies the latest one every
+ * CONFIG_ZMK_KEYSTROKE_STATS_PROSPECTOR_UPDATE_INTERVAL_MS.
+ *
+ * The widgets are created by a work item on the display work queue, once
+ * the Prospector screen exists.
  */
 
 #if CONFIG_LVGL
@@ -33,67 +48,162 @@ LOG_MODULE_REGISTER(keystroke_stats_prospector, CONFIG_ZMK_KEYSTROKE_STATS_LOG_L
 LV_FONT_DECLARE(FRAC_Regular_32);
 LV_FONT_DECLARE(FoundryGridnikMedium_20);
 
+/* A number label and the value and text it currently shows */
+struct stat_label {
+    lv_obj_t *obj;
+    uint32_t value;
+    char text[ZMK_KEYSTROKE_STATS_COUNT_STR_LEN];
+};
+
 static lv_obj_t *widget_container = NULL;
-static lv_obj_t *label_today_num = NULL;
+static struct stat_label today_num;
 static lv_obj_t *label_today_text = NULL;
-static lv_obj_t *label_yesterday_num = NULL;
+static struct stat_label yesterday_num;
 static lv_obj_t *label_yesterday_text = NULL;
-static lv_obj_t *label_total_num = NULL;
+static struct stat_label total_num;
 static lv_obj_t *label_total_text = NULL;
 
+/* Label updates made and avoided because the text was unchanged */
+static uint32_t redraws;
+static uint32_t redraws_skipped;
+
+/* The values shown by the widget */
+struct stats_snapshot {
+    uint32_t today;
+    uint32_t yesterday;
+    uint32_t total;
+#if CONFIG_ZMK_KEYSTROKE_STATS_PROSPECTOR_SPARKLINE
+    uint16_t day;
+#endif
+};
+
+/* Latest snapshot not yet shown; posting again replaces it */
+static struct {
+    struct k_spinlock lock;
+    struct stats_snapshot snapshot;
+    bool pending;
+    uint32_t posted;
+    uint32_t replaced;
+} mailbox;
+
+static lv_timer_t *update_timer = NULL;
+
 /**
- * @brief Format number with hybrid approach
+ * @brief Show a value, touching the label only if its text changes
  *
- * - 0-9999: Display as-is (e.g., "1234")
- * - 10000+: Display with K suffix (e.g., "12.3K")
+ * Above 9999 most keystrokes do not change the text ("12.3K"), so the
+ * formatted text is compared as well as the value.
  */
-static void format_number(uint32_t value, char *buf, size_t buf_size) {
-    if (value < 10000) {
-        snprintf(buf, buf_size, "%u", value);
-    } else {
-        uint32_t thousands = value / 1000;
-        uint32_t remainder = (value % 1000) / 100;
-
-        if (remainder == 0) {
-            snprintf(buf, buf_size, "%uK", thousands);
-        } else {
-            snprintf(buf, buf_size, "%u.%uK", thousands, remainder);
-        }
+static void set_stat(struct stat_label *label, uint32_t value) {
+    char buf[sizeof(label->text)];
+
+    if (value == label->value) {
+        redraws_skipped++;
+        return;
     }
-}
 
-static void update_display(const struct zmk_keystroke_stats *stats, void *user_data) {
-    ARG_UNUSED(user_data);
+    label->value = value;
+    zmk_keystroke_stats_format_count(value, buf, sizeof(buf));
+    if (strcmp(buf, label->text) == 0) {
+        redraws_skipped++;
+        return;
+    }
+
+    /* The label shows the cache directly, no copy on the LVGL heap */
+    strcpy(label->text, buf);
+    lv_label_set_text_static(label->obj, label->text);
+    redraws++;
+}
 
-    if (widget_container == NULL || label_today_num == NULL) {
+/**
+ * @brief Show a snapshot, display thread only
+ */
+static void update_display(const struct stats_snapshot *snapshot) {
+    if (widget_container == NULL || today_num.obj == NULL) {
         return;
     }
 
-    char buf[16];
+    set_stat(&today_num, snapshot->today);
+    set_stat(&yesterday_num, snapshot->yesterday);
+    set_stat(&total_num, snapshot->total);
 
-    /* Update TODAY */
-    format_number(stats->today_keystrokes, buf, sizeof(buf));
-    lv_label_set_text(label_today_num, buf);
+    LOG_DBG("Prospector UI updated: Today=%u, Yesterday=%u, Total=%u "
+            "(%u label redraws, %u skipped)",
+            snapshot->today, snapshot->yesterday, snapshot->total,
+            redraws, redraws_skipped);
+}
 
-    /* Update YESTERDAY */
-    format_number(stats->yesterday_keystrokes, buf, sizeof(buf));
-    lv_label_set_text(label_yesterday_num, buf);
+/**
+ * @brief Statistics callback: post a snapshot for the display thread
+ *
+ * Runs in the keystroke listener, so it only copies a few words.
+ */
+static void post_snapshot(const struct zmk_keystroke_stats *stats, void *user_data);
+
+/*
+ * Key counts only change with the total, and the heatmap reads them on the
+ * display thread, so top keys are never computed in the listener for it.
+ */
+static struct zmk_keystroke_stats_subscriber subscriber = {
+    .callback = post_snapshot,
+    .interest = ZMK_KEYSTROKE_STATS_CHANGED_TODAY | ZMK_KEYSTROKE_STATS_CHANGED_YESTERDAY |
+                ZMK_KEYSTROKE_STATS_CHANGED_TOTAL | ZMK_KEYSTROKE_STATS_CHANGED_DAY,
+};
+
+static void post_snapshot(const struct zmk_keystroke_stats *stats, void *user_data) {
+    ARG_UNUSED(user_data);
+
+    k_spinlock_key_t key = k_spin_lock(&mailbox.lock);
+
+    mailbox.replaced += mailbox.pending;
+    mailbox.snapshot.today = stats->today_keystrokes;
+    mailbox.snapshot.yesterday = stats->yesterday_keystrokes;
+    mailbox.snapshot.total = stats->total_keystrokes;
+#if CONFIG_ZMK_KEYSTROKE_STATS_PROSPECTOR_SPARKLINE
+    mailbox.snapshot.day = stats->current_uptime_day;
+#endif
+    mailbox.pending = true;
+    mailbox.posted++;
 
-    /* Update TOTAL */
-    format_number(stats->total_keystrokes, buf, sizeof(buf));
-    lv_label_set_text(label_total_num, buf);
+    k_spin_unlock(&mailbox.lock, key);
+}
+
+/**
+ * @brief LVGL timer: show the latest posted snapshot, if any
+ */
+static void update_timer_cb(lv_timer_t *timer) {
+    ARG_UNUSED(timer);
+
+    struct stats_snapshot snapshot;
+    bool pending;
 
-    LOG_DBG("Prospector UI updated: Today=%u, Yesterday=%u, Total=%u",
-            stats->today_keystrokes,
-            stats->yesterday_keystrokes,
-            stats->total_keystrokes);
+    k_spinlock_key_t key = k_spin_lock(&mailbox.lock);
+    pending = mailbox.pending;
+    snapshot = mailbox.snapshot;
+    mailbox.pending = false;
+    k_spin_unlock(&mailbox.lock, key);
+
+    if (!pending) {
+        return;
+    }
+
+    /* Counters only, a torn read is harmless */
+    LOG_DBG("Snapshots posted: %u, replaced before shown: %u", mailbox.posted,
+            mailbox.replaced);
+    update_display(&snapshot);
+#if CONFIG_ZMK_KEYSTROKE_STATS_PROSPECTOR_HEATMAP
+    keystroke_stats_heatmap_update();
+#endif
+#if CONFIG_ZMK_KEYSTROKE_STATS_PROSPECTOR_SPARKLINE
+    keystroke_stats_sparkline_update(snapshot.day, snapshot.today);
+#endif
 }
 
 /**
  * @brief Create a single stat column (number + label)
  */
 static void create_stat_column(lv_obj_t *parent, const char *label_text,
-                               lv_obj_t **out_num, lv_obj_t **out_text,
+                               struct stat_label *out_num, lv_obj_t **out_text,
                                bool is_highlighted) {
     /* Container for this stat */
     lv_obj_t *col = lv_obj_create(parent);
@@ -112,7 +222,10 @@ static void create_stat_column(lv_obj_t *parent, const char *label_text,
     } else {
         lv_obj_set_style_text_color(num, lv_color_white(), 0);
     }
-    lv_label_set_text(num, "0");
+    out_num->obj = num;
+    out_num->value = 0;
+    strcpy(out_num->text, "0");
+    lv_label_set_text_static(num, out_num->text);
     lv_obj_align(num, LV_ALIGN_CENTER, 0, -6);
 
     /* Text label */
@@ -122,18 +235,22 @@ static void create_stat_column(lv_obj_t *parent, const char *label_text,
     lv_label_set_text(text, label_text);
     lv_obj_align(text, LV_ALIGN_CENTER, 0, 10);
 
-    *out_num = num;
     *out_text = text;
 }
 
-static int prospector_ui_init(void) {
-    LOG_INF("Initializing Prospector LVGL UI");
+/**
+ * @brief Create the widgets on the Prospector screen, display thread only
+ *
+ * @return 0 on success, -EAGAIN if the screen does not exist yet
+ */
+static int create_widgets(void) {
+    if (!zmk_display_is_initialized()) {
+        return -EAGAIN;
+    }
 
-    /* Get the Prospector screen */
     lv_obj_t *screen = prospector_get_screen();
     if (screen == NULL) {
-        LOG_ERR("Failed to get Prospector screen - may not be initialized yet");
-        return -ENODEV;
+        return -EAGAIN;
     }
 
     /* Create main container widget - positioned at bottom above battery bar */
@@ -151,31 +268,107 @@ static int prospector_ui_init(void) {
 
     /* Create three columns: TODAY, YESTERDAY, TOTAL */
     create_stat_column(widget_container, "TODAY",
-                      &label_today_num, &label_today_text, true);
+                      &today_num, &label_today_text, true);
 
     create_stat_column(widget_container, "YESTERDAY",
-                      &label_yesterday_num, &label_yesterday_text, false);
+                      &yesterday_num, &label_yesterday_text, false);
 
     create_stat_column(widget_container, "TOTAL",
-                      &label_total_num, &label_total_text, false);
+                      &total_num, &label_total_text, false);
 
-    /* Register callback for statistics updates */
-    int ret = zmk_keystroke_stats_register_callback(update_display, NULL);
-    if (ret < 0) {
-        LOG_ERR("Failed to register callback: %d", ret);
-        return ret;
+#if CONFIG_ZMK_KEYSTROKE_STATS_PROSPECTOR_HEATMAP ||                                          \
+    CONFIG_ZMK_KEYSTROKE_STATS_PROSPECTOR_SPARKLINE
+    /* Optional widgets stack up above the statistics row */
+    lv_coord_t widget_y = -48 - 48 - 4;
+#endif
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_PROSPECTOR_HEATMAP
+    /* The rest of the UI works without it */
+    lv_obj_t *heatmap = keystroke_stats_heatmap_create(
+        screen, 220, CONFIG_ZMK_KEYSTROKE_STATS_PROSPECTOR_HEATMAP_HEIGHT);
+    if (heatmap != NULL) {
+        lv_obj_align(heatmap, LV_ALIGN_BOTTOM_MID, 0, widget_y);
+        widget_y -= CONFIG_ZMK_KEYSTROKE_STATS_PROSPECTOR_HEATMAP_HEIGHT + 4;
     }
+#endif
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_PROSPECTOR_SPARKLINE
+    lv_obj_t *sparkline = keystroke_stats_sparkline_create(
+        screen, 220, CONFIG_ZMK_KEYSTROKE_STATS_PROSPECTOR_SPARKLINE_HEIGHT);
+    lv_obj_align(sparkline, LV_ALIGN_BOTTOM_MID, 0, widget_y);
+#endif
 
     /* Initial update with current stats */
-    const struct zmk_keystroke_stats *stats = zmk_keystroke_stats_get_current();
-    if (stats != NULL) {
-        update_display(stats, NULL);
+    struct zmk_keystroke_stats stats;
+    if (zmk_keystroke_stats_get(&stats) == 0) {
+        struct stats_snapshot snapshot = {
+            .today = stats.today_keystrokes,
+            .yesterday = stats.yesterday_keystrokes,
+            .total = stats.total_keystrokes,
+#if CONFIG_ZMK_KEYSTROKE_STATS_PROSPECTOR_SPARKLINE
+            .day = stats.current_uptime_day,
+#endif
+        };
+
+        update_display(&snapshot);
+#if CONFIG_ZMK_KEYSTROKE_STATS_PROSPECTOR_HEATMAP
+        keystroke_stats_heatmap_update();
+#endif
+#if CONFIG_ZMK_KEYSTROKE_STATS_PROSPECTOR_SPARKLINE
+        keystroke_stats_sparkline_update(snapshot.day, snapshot.today);
+#endif
+    }
+
+    update_timer = lv_timer_create(update_timer_cb,
+                                   CONFIG_ZMK_KEYSTROKE_STATS_PROSPECTOR_UPDATE_INTERVAL_MS,
+                                   NULL);
+    if (update_timer == NULL) {
+        LOG_ERR("Failed to create update timer");
+        return -ENOMEM;
+    }
+
+    /* Subscribe to statistics updates */
+    int ret = zmk_keystroke_stats_subscribe(&subscriber);
+    if (ret < 0) {
+        LOG_ERR("Failed to subscribe: %d", ret);
+        return ret;
     }
 
     LOG_INF("Prospector UI initialized successfully");
     return 0;
 }
 
+/* The display thread creates the screen after the init functions run */
+#define CREATE_RETRY_MS 500
+#define CREATE_MAX_ATTEMPTS 20
+
+static void create_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(create_work, create_work_handler);
+static int create_attempts;
+
+static void create_work_handler(struct k_work *work) {
+    ARG_UNUSED(work);
+
+    int ret = create_widgets();
+    if (ret == -EAGAIN && ++create_attempts < CREATE_MAX_ATTEMPTS) {
+        k_work_schedule_for_queue(zmk_display_work_q(), &create_work, K_MSEC(CREATE_RETRY_MS));
+        return;
+    }
+
+    if (ret < 0) {
+        LOG_ERR("Failed to create the Prospector UI: %d", ret);
+    }
+}
+
+static int prospector_ui_init(void) {
+    LOG_INF("Initializing Prospector LVGL UI");
+
+    /* LVGL may only be used from the display thread */
+    k_work_schedule_for_queue(zmk_display_work_q(), &create_work, K_NO_WAIT);
+
+    return 0;
+}
+
 #else /* !CONFIG_LVGL */
 
 static int prospector_ui_init(void) {
@@ -185,5 +378,5 @@ static int prospector_ui_init(void) {
 
 #endif /* CONFIG_LVGL */
 
-// DISABLED: UI is integrated directly into Prospector's zmk_display_status_screen()
-// SYS_INIT(prospector_ui_init, APPLICATION, 92);
+/* After ZMK's display init, which starts the display work queue */
+KEYSTROKE_STATS_UI_DEFINE(prospector, prospector_ui_init, 92);
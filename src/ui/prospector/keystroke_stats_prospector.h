@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <lvgl.h>
+#include <stdint.h>
+
+/**
+ * @file keystroke_stats_prospector.h
+ * @brief Widgets shared within the Prospector UI (not public API)
+ *
+ * All functions must be called from the display thread.
+ */
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_PROSPECTOR_HEATMAP
+
+/**
+ * @brief Create the key heatmap from the selected physical layout
+ *
+ * @return The widget, NULL if there is no physical layout
+ */
+lv_obj_t *keystroke_stats_heatmap_create(lv_obj_t *parent, lv_coord_t width, lv_coord_t height);
+
+/**
+ * @brief Read the key counts and recolor keys whose bucket changed
+ */
+void keystroke_stats_heatmap_update(void);
+
+#endif /* CONFIG_ZMK_KEYSTROKE_STATS_PROSPECTOR_HEATMAP */
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_PROSPECTOR_SPARKLINE
+
+/**
+ * @brief Create the daily history bar chart
+ */
+lv_obj_t *keystroke_stats_sparkline_create(lv_obj_t *parent, lv_coord_t width,
+                                           lv_coord_t height);
+
+/**
+ * @brief Show today's count, rebuilding the chart if the day changed
+ *
+ * @param day Current day number
+ * @param today Today's keystrokes
+ */
+void keystroke_stats_sparkline_update(uint16_t day, uint32_t today);
+
+#endif /* CONFIG_ZMK_KEYSTROKE_STATS_PROSPECTOR_SPARKLINE */
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zmk/keystroke_stats.h>
+#include <lvgl.h>
+
+#include "keystroke_stats_prospector.h"
+
+LOG_MODULE_REGISTER(keystroke_stats_sparkline, CONFIG_ZMK_KEYSTROKE_STATS_LOG_LEVEL);
+
+/*
+ * Bar chart of the last DAILY_HISTORY_DAYS days plus today, one bar per
+ * calendar (or uptime) day, days without history shown empty.
+ *
+ * The chart range is its height in pixels, so values are scaled once in
+ * integer math to whole pixels. The scale leaves headroom above the
+ * largest day; while today stays below it, an update only touches the
+ * last bar, and not at all if its height in pixels did not change. The
+ * whole series is only rebuilt (and the full chart redrawn) at day
+ * rollover or when today outgrows the scale.
+ *
+ * The chart is in circular update mode: points are drawn by index, and
+ * lv_chart_set_next_value() after moving the start point to the last bar
+ * rewrites and invalidates only that bar.
+ */
+
+#define POINTS (CONFIG_ZMK_KEYSTROKE_STATS_DAILY_HISTORY_DAYS + 1)
+#define TODAY_POINT (POINTS - 1)
+
+static lv_obj_t *chart = NULL;
+static lv_chart_series_t *series = NULL;
+
+/* Series storage, used by the chart directly */
+static lv_coord_t points[POINTS];
+static lv_coord_t range;
+
+/* Day shown as the last bar, and the count that maps to the full height */
+static uint16_t shown_day;
+static uint32_t scale_max;
+
+/* Full rebuilds and single bar updates since boot */
+static uint32_t rebuilds;
+static uint32_t bar_updates;
+
+static lv_coord_t scale(uint32_t count) {
+    return scale_max == 0 ? 0 : (lv_coord_t)((uint64_t)count * range / scale_max);
+}
+
+/**
+ * @brief Refill the whole series from the history
+ */
+static void rebuild(uint16_t day, uint32_t today) {
+    struct zmk_keystroke_stats stats;
+    uint32_t counts[POINTS] = {0};
+    uint32_t max = today;
+
+    if (zmk_keystroke_stats_get(&stats) < 0) {
+        return;
+    }
+
+    counts[TODAY_POINT] = today;
+    for (int i = 0; i < stats.daily_stats_count; i++) {
+        const struct zmk_keystroke_stats_daily_entry *entry = &stats.daily_stats[i];
+        uint16_t age = day - entry->day;
+
+        if (entry->day >= day || age > TODAY_POINT) {
+            continue;
+        }
+
+        counts[TODAY_POINT - age] = zmk_keystroke_stats_daily_entry_get_keystrokes(entry);
+        max = MAX(max, counts[TODAY_POINT - age]);
+    }
+
+    /* Headroom so a growing today does not force a rebuild on every update */
+    scale_max = max + MAX(max / 4, 64);
+    shown_day = day;
+
+    for (int i = 0; i < POINTS; i++) {
+        points[i] = scale(counts[i]);
+    }
+
+    lv_chart_refresh(chart);
+    rebuilds++;
+
+    LOG_DBG("Sparkline rebuilt for day %u (scale %u, %u rebuilds, %u bar updates)", day,
+            scale_max, rebuilds, bar_updates);
+}
+
+void keystroke_stats_sparkline_update(uint16_t day, uint32_t today) {
+    if (chart == NULL) {
+        return;
+    }
+
+    if (day != shown_day || today > scale_max) {
+        rebuild(day, today);
+        return;
+    }
+
+    lv_coord_t value = scale(today);
+    if (value == points[TODAY_POINT]) {
+        return;
+    }
+
+    lv_chart_set_x_start_point(chart, series, TODAY_POINT);
+    lv_chart_set_next_value(chart, series, value);
+    bar_updates++;
+}
+
+lv_obj_t *keystroke_stats_sparkline_create(lv_obj_t *parent, lv_coord_t width,
+                                           lv_coord_t height) {
+    chart = lv_chart_create(parent);
+    lv_obj_set_size(chart, width, height);
+    lv_obj_set_style_bg_opa(chart, LV_OPA_TRANSP, LV_PART_MAIN);
+    lv_obj_set_style_border_width(chart, 0, LV_PART_MAIN);
+    lv_obj_set_style_pad_all(chart, 0, LV_PART_MAIN);
+    lv_chart_set_div_line_count(chart, 0, 0);
+
+    lv_chart_set_type(chart, LV_CHART_TYPE_BAR);
+    lv_chart_set_update_mode(chart, LV_CHART_UPDATE_MODE_CIRCULAR);
+    lv_chart_set_point_count(chart, POINTS);
+
+    range = height;
+    lv_chart_set_range(chart, LV_CHART_AXIS_PRIMARY_Y, 0, range);
+
+    series = lv_chart_add_series(chart, lv_color_hex(0x00ffe5), LV_CHART_AXIS_PRIMARY_Y);
+    lv_chart_set_ext_y_array(chart, series, points);
+
+    /* Forces a rebuild on the first update */
+    shown_day = UINT16_MAX;
+
+    return chart;
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Micro-benchmark of zmk_keystroke_stats_format_count() against the
+ * snprintf-based formatter it replaced. Not a test, run it by hand:
+ *
+ *   ./bench_format
+ *   cmake --build <dir> --target bench_format_size
+ *
+ * The first checks that both give the same text below one million (above
+ * it the old one kept growing K values) and prints the time per value; the
+ * second prints the code size of each at -Os. The snprintf object does not
+ * include snprintf itself, which comes from libc; on target that is the
+ * code the formatter keeps out of a build without other snprintf users.
+ * Both are host numbers, they only compare the two.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <zmk/keystroke_stats.h>
+
+#define SAME_OUTPUT_BELOW 1000000
+#define ROUNDS 10000000
+#define STEP 4099
+
+void bench_format_snprintf(uint32_t value, char *buf, size_t buf_size);
+
+static double now_s(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(void) {
+    char fast[ZMK_KEYSTROKE_STATS_COUNT_STR_LEN];
+    char slow[16];
+    volatile char sink = 0;
+    uint32_t value;
+    double start, fast_s, slow_s;
+
+    for (value = 0; value < SAME_OUTPUT_BELOW; value++) {
+        zmk_keystroke_stats_format_count(value, fast, sizeof(fast));
+        bench_format_snprintf(value, slow, sizeof(slow));
+        if (strcmp(fast, slow) != 0) {
+            printf("%u: \"%s\", snprintf path \"%s\"\n", value, fast, slow);
+            return 1;
+        }
+    }
+
+    /* Small counts and large ones alike */
+    start = now_s();
+    for (value = 0; value < ROUNDS; value++) {
+        zmk_keystroke_stats_format_count(value * STEP, fast, sizeof(fast));
+        sink ^= fast[0];
+    }
+    fast_s = now_s() - start;
+
+    start = now_s();
+    for (value = 0; value < ROUNDS; value++) {
+        bench_format_snprintf(value * STEP, slow, sizeof(slow));
+        sink ^= slow[0];
+    }
+    slow_s = now_s() - start;
+
+    printf("Same text for 0..%u\n", SAME_OUTPUT_BELOW - 1);
+    printf("format_count: %.1f ns per value\n", fast_s * 1e9 / ROUNDS);
+    printf("snprintf:     %.1f ns per value\n", slow_s * 1e9 / ROUNDS);
+
+    return 0;
+}
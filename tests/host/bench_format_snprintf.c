@@ -0,0 +1,24 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+/* The snprintf-based format_number() the UIs used before, for comparison */
+void bench_format_snprintf(uint32_t value, char *buf, size_t buf_size) {
+    if (value < 10000) {
+        snprintf(buf, buf_size, "%u", value);
+    } else {
+        uint32_t thousands = value / 1000;
+        uint32_t remainder = (value % 1000) / 100;
+
+        if (remainder == 0) {
+            snprintf(buf, buf_size, "%uK", thousands);
+        } else {
+            snprintf(buf, buf_size, "%u.%uK", thousands, remainder);
+        }
+    }
+}
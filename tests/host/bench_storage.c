@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Flash cost of saving and loading through settings against the direct
+ * backend. Built once per backend, not a test, run them by hand:
+ *
+ *   ./bench_storage_settings
+ *   ./bench_storage_direct
+ *
+ * Each fills the heatmap, writes a checkpoint of every section, then small
+ * journal records, then loads it all back, and prints per operation the
+ * records written, the flash bytes they take (data plus allocation table
+ * entries, plus name records for settings), the bytes of key strings built
+ * or parsed, and the host time. The settings and NVS fakes are both
+ * in-memory tables, so the time only compares the module's own work around
+ * them, not flash latency on target.
+ */
+
+#include "keystroke_stats.c"
+
+#include <stdio.h>
+#include <time.h>
+
+#include "fake_zephyr.h"
+
+#if CONFIG_ZMK_KEYSTROKE_STATS_STORAGE_DIRECT
+#define BACKEND "direct"
+#else
+#define BACKEND "settings"
+#endif
+
+#define CHECKPOINTS 100
+#define JOURNAL_SAVES 20
+#define LOADS 100
+
+static struct zmk_position_state_changed key_event;
+
+struct zmk_position_state_changed *as_zmk_position_state_changed(const zmk_event_t *eh) {
+    return &key_event;
+}
+
+int raise_zmk_keystroke_stats_changed(struct zmk_keystroke_stats_changed ev) { return 0; }
+
+static void press(uint32_t position, int times) {
+    for (int i = 0; i < times; i++) {
+        key_event.position = position;
+        key_event.state = true;
+        keystroke_event_listener(NULL);
+    }
+}
+
+static double now_us(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+struct cost {
+    int writes;
+    size_t flash_bytes;
+    size_t name_bytes;
+    double start_us;
+};
+
+static struct cost cost;
+
+static void cost_start(void) {
+    cost.writes = fake_settings_writes + fake_store_writes;
+    cost.flash_bytes = fake_flash_bytes;
+    cost.name_bytes = fake_name_bytes;
+    cost.start_us = now_us();
+}
+
+static void cost_print(const char *what, int times) {
+    double us = now_us() - cost.start_us;
+    int writes = fake_settings_writes + fake_store_writes - cost.writes;
+
+    printf("%-10s %-10s %6.1f records %8.1f flash bytes %8.1f name bytes %8.2f us\n", BACKEND,
+           what, (double)writes / times, (double)(fake_flash_bytes - cost.flash_bytes) / times,
+           (double)(fake_name_bytes - cost.name_bytes) / times, us / times);
+}
+
+static void save(void) {
+    keystroke_stats_init();
+
+    for (uint32_t position = 0; position < CONFIG_ZMK_KEYSTROKE_STATS_MAX_KEY_POSITIONS;
+         position++) {
+        press(position, position + 1);
+    }
+
+    cost_start();
+    for (int i = 0; i < CHECKPOINTS; i++) {
+        keystroke_stats_journal_invalidate();
+        mark_dirty(KEYSTROKE_STATS_SECTIONS_ALL);
+        press(i % CONFIG_ZMK_KEYSTROKE_STATS_MAX_KEY_POSITIONS, 1);
+        keystroke_stats_save_now();
+    }
+    cost_print("checkpoint", CHECKPOINTS);
+
+    cost_start();
+    for (int i = 0; i < JOURNAL_SAVES; i++) {
+        press(i, 5);
+        keystroke_stats_save_now();
+    }
+    cost_print("journal", JOURNAL_SAVES);
+}
+
+static void load(void) {
+    cost_start();
+    for (int i = 0; i < LOADS; i++) {
+        keystroke_stats_load_from_settings();
+    }
+    cost_print("load", LOADS);
+}
+
+int main(void) {
+    fake_settings_clear();
+    fake_boot(save);
+    fake_boot(load);
+
+    return fake_check_result();
+}
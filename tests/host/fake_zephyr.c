@@ -0,0 +1,544 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/fs/nvs.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/printk.h>
+#include <zmk/activity.h>
+
+#include "fake_zephyr.h"
+
+int64_t fake_now;
+int fake_settings_writes;
+int fake_settings_writes_left = -1;
+int fake_store_writes;
+size_t fake_flash_bytes;
+size_t fake_name_bytes;
+
+static int failed_checks;
+
+void fake_check_failed(const char *file, int line, const char *cond) {
+    fprintf(stderr, "%s:%d: check failed: %s\n", file, line, cond);
+    failed_checks++;
+}
+
+int fake_check_result(void) {
+    return failed_checks == 0 ? 0 : 1;
+}
+
+/* Kernel */
+
+int64_t k_uptime_get(void) { return fake_now; }
+uint32_t k_uptime_get_32(void) { return (uint32_t)fake_now; }
+
+int64_t k_uptime_delta(int64_t *reftime) {
+    int64_t delta = fake_now - *reftime;
+
+    *reftime = fake_now;
+    return delta;
+}
+
+/* 64 MHz cycle counter that advances on every read */
+static uint32_t cycles;
+uint32_t k_cycle_get_32(void) { return cycles += 64; }
+uint64_t k_cyc_to_us_floor64(uint64_t c) { return c / 64; }
+uint32_t k_cyc_to_us_floor32(uint32_t c) { return c / 64; }
+uint64_t k_cyc_to_ns_floor64(uint64_t c) { return c * 1000 / 64; }
+
+int k_mutex_init(struct k_mutex *mutex) { return 0; }
+int k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout) {
+    mutex->lock_count++;
+    return 0;
+}
+
+int k_mutex_unlock(struct k_mutex *mutex) {
+    mutex->lock_count--;
+    return 0;
+}
+
+k_spinlock_key_t k_spin_lock(struct k_spinlock *lock) { return (k_spinlock_key_t){0}; }
+void k_spin_unlock(struct k_spinlock *lock, k_spinlock_key_t key) {}
+
+void k_work_init(struct k_work *work, k_work_handler_t handler) { work->handler = handler; }
+
+void k_work_init_delayable(struct k_work_delayable *dwork, k_work_handler_t handler) {
+    dwork->work.handler = handler;
+}
+
+int k_work_submit(struct k_work *work) { return 0; }
+int k_work_submit_to_queue(struct k_work_q *queue, struct k_work *work) { return 0; }
+int k_work_schedule_for_queue(struct k_work_q *queue, struct k_work_delayable *dwork,
+                              k_timeout_t delay) {
+    if (dwork->pending) {
+        return 0;
+    }
+
+    dwork->pending = true;
+    dwork->delay_ms = delay.ticks;
+    return 1;
+}
+
+int k_work_schedule(struct k_work_delayable *dwork, k_timeout_t delay) {
+    return k_work_schedule_for_queue(NULL, dwork, delay);
+}
+
+int k_work_reschedule_for_queue(struct k_work_q *queue, struct k_work_delayable *dwork,
+                                k_timeout_t delay) {
+    dwork->pending = true;
+    dwork->delay_ms = delay.ticks;
+    return 1;
+}
+
+int k_work_reschedule(struct k_work_delayable *dwork, k_timeout_t delay) {
+    return k_work_reschedule_for_queue(NULL, dwork, delay);
+}
+
+int k_work_cancel_delayable(struct k_work_delayable *dwork) {
+    dwork->pending = false;
+    return 0;
+}
+
+bool k_work_delayable_is_pending(const struct k_work_delayable *dwork) { return dwork->pending; }
+
+bool fake_work_run(struct k_work_delayable *dwork) {
+    if (!dwork->pending) {
+        return false;
+    }
+
+    dwork->pending = false;
+    dwork->work.handler(&dwork->work);
+    return true;
+}
+
+struct k_work_delayable *k_work_delayable_from_work(struct k_work *work) {
+    return CONTAINER_OF(work, struct k_work_delayable, work);
+}
+
+void k_work_queue_init(struct k_work_q *queue) {}
+void k_work_queue_start(struct k_work_q *queue, void *stack, size_t stack_size, int prio,
+                        const struct k_work_queue_config *cfg) {}
+void k_thread_name_set(void *thread, const char *name) {}
+
+void k_timer_init(struct k_timer *timer, void (*expiry)(struct k_timer *),
+                  void (*stop)(struct k_timer *)) {}
+void k_timer_start(struct k_timer *timer, k_timeout_t duration, k_timeout_t period) {}
+void k_timer_stop(struct k_timer *timer) {}
+uint32_t k_timer_remaining_get(struct k_timer *timer) { return 0; }
+int64_t k_timer_remaining_ticks(struct k_timer *timer) { return 0; }
+
+int snprintk(char *str, size_t size, const char *fmt, ...) {
+    va_list ap;
+
+    va_start(ap, fmt);
+    int ret = vsnprintf(str, size, fmt, ap);
+    va_end(ap);
+
+    return ret;
+}
+
+uint32_t crc32_ieee_update(uint32_t crc, const uint8_t *data, size_t len) {
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+        }
+    }
+
+    return ~crc;
+}
+
+uint32_t crc32_ieee(const uint8_t *data, size_t len) { return crc32_ieee_update(0, data, len); }
+
+const struct device fake_device = {.name = "fake"};
+
+bool device_is_ready(const struct device *dev) { return true; }
+
+enum zmk_activity_state zmk_activity_get_state(void) { return ZMK_ACTIVITY_ACTIVE; }
+
+/*
+ * Settings and NVS records, in memory shared with the boots forked off by
+ * fake_boot() so that they survive the power cycle
+ */
+
+#define MAX_RECORDS 64
+#define MAX_RECORD_LEN 2048
+
+/* Flash cost of a record besides its data: an NVS allocation table entry */
+#define ENTRY_OVERHEAD 8
+
+struct record {
+    char name[SETTINGS_MAX_NAME_LEN + 1];
+    uint8_t value[MAX_RECORD_LEN];
+    size_t len;
+};
+
+struct records {
+    int count;
+    struct record entries[MAX_RECORDS];
+};
+
+static struct records *store;
+static struct records *nvs_store;
+
+static struct records *records_map(void) {
+    struct records *r =
+        mmap(NULL, sizeof(*r), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+    if (r == MAP_FAILED) {
+        perror("mmap");
+        exit(2);
+    }
+
+    return r;
+}
+
+static void store_init(void) {
+    if (store == NULL) {
+        store = records_map();
+        nvs_store = records_map();
+    }
+}
+
+static struct record *find_record(struct records *r, const char *name) {
+    for (int i = 0; i < r->count; i++) {
+        if (strcmp(r->entries[i].name, name) == 0) {
+            return &r->entries[i];
+        }
+    }
+
+    return NULL;
+}
+
+static int set_record(struct records *r, const char *name, const void *value, size_t len) {
+    struct record *rec = find_record(r, name);
+
+    if (len > MAX_RECORD_LEN) {
+        return -ENOMEM;
+    }
+    if (rec == NULL) {
+        if (r->count == MAX_RECORDS || strlen(name) > SETTINGS_MAX_NAME_LEN) {
+            return -ENOMEM;
+        }
+        rec = &r->entries[r->count++];
+        strcpy(rec->name, name);
+    }
+
+    memcpy(rec->value, value, len);
+    rec->len = len;
+
+    return 0;
+}
+
+static bool delete_record(struct records *r, const char *name) {
+    struct record *rec = find_record(r, name);
+
+    if (rec == NULL) {
+        return false;
+    }
+
+    *rec = r->entries[--r->count];
+    return true;
+}
+
+static struct record *find_setting(const char *name) {
+    store_init();
+    return find_record(store, name);
+}
+
+int fake_settings_set(const char *name, const void *value, size_t len) {
+    store_init();
+    return set_record(store, name, value, len);
+}
+
+int fake_settings_get(const char *name, void *value, size_t size) {
+    const struct record *s = find_setting(name);
+
+    if (s == NULL) {
+        return -ENOENT;
+    }
+
+    memcpy(value, s->value, MIN(size, s->len));
+    return s->len;
+}
+
+bool fake_settings_exists(const char *name) {
+    return find_setting(name) != NULL;
+}
+
+int fake_settings_count(void) {
+    store_init();
+    return store->count;
+}
+
+void fake_settings_clear(void) {
+    store_init();
+    memset(store, 0, sizeof(*store));
+    memset(nvs_store, 0, sizeof(*nvs_store));
+}
+
+/*
+ * Flash use as the settings NVS backend would have it: a new key costs a
+ * name record on top of the value record, a delete marks both deleted.
+ */
+
+int settings_save_one(const char *name, const void *value, size_t val_len) {
+    if (fake_settings_writes_left == 0) {
+        return -EIO;
+    }
+    if (fake_settings_writes_left > 0) {
+        fake_settings_writes_left--;
+    }
+
+    bool new_name = !fake_settings_exists(name);
+    int ret = fake_settings_set(name, value, val_len);
+    if (ret == 0) {
+        fake_settings_writes++;
+        fake_flash_bytes += val_len + ENTRY_OVERHEAD;
+        if (new_name) {
+            fake_flash_bytes += strlen(name) + ENTRY_OVERHEAD;
+        }
+        fake_name_bytes += strlen(name);
+    }
+
+    return ret;
+}
+
+int settings_delete(const char *name) {
+    store_init();
+
+    fake_name_bytes += strlen(name);
+    if (delete_record(store, name)) {
+        fake_flash_bytes += 2 * ENTRY_OVERHEAD;
+    }
+
+    return 0;
+}
+
+/* NVS, records named by their decimal ID */
+
+static void id_name(char *name, uint16_t id) {
+    snprintf(name, SETTINGS_MAX_NAME_LEN + 1, "%u", id);
+}
+
+int fake_store_get(uint16_t id, void *value, size_t size) {
+    char name[SETTINGS_MAX_NAME_LEN + 1];
+
+    store_init();
+    id_name(name, id);
+
+    const struct record *rec = find_record(nvs_store, name);
+    if (rec == NULL) {
+        return -ENOENT;
+    }
+
+    memcpy(value, rec->value, MIN(size, rec->len));
+    return rec->len;
+}
+
+int fake_store_count(void) {
+    store_init();
+    return nvs_store->count;
+}
+
+void fake_store_clear(void) {
+    store_init();
+    memset(nvs_store, 0, sizeof(*nvs_store));
+}
+
+int flash_get_page_info_by_offs(const struct device *dev, off_t offset,
+                                struct flash_pages_info *info) {
+    info->start_offset = offset - offset % 4096;
+    info->size = 4096;
+    info->index = offset / 4096;
+    return 0;
+}
+
+int nvs_mount(struct nvs_fs *fs) {
+    store_init();
+    return 0;
+}
+
+/* Like NVS, data equal to what is stored is not written again */
+ssize_t nvs_write(struct nvs_fs *fs, uint16_t id, const void *data, size_t len) {
+    char name[SETTINGS_MAX_NAME_LEN + 1];
+
+    if (fake_settings_writes_left == 0) {
+        return -EIO;
+    }
+    if (fake_settings_writes_left > 0) {
+        fake_settings_writes_left--;
+    }
+
+    id_name(name, id);
+
+    /* Writing no data deletes the record */
+    if (len == 0) {
+        delete_record(nvs_store, name);
+        return 0;
+    }
+
+    const struct record *rec = find_record(nvs_store, name);
+    if (rec != NULL && rec->len == len && memcmp(rec->value, data, len) == 0) {
+        return 0;
+    }
+
+    int ret = set_record(nvs_store, name, data, len);
+    if (ret < 0) {
+        return ret;
+    }
+
+    fake_store_writes++;
+    fake_flash_bytes += len + ENTRY_OVERHEAD;
+    return len;
+}
+
+/* Returns the stored length, which may be more than len */
+ssize_t nvs_read(struct nvs_fs *fs, uint16_t id, void *data, size_t len) {
+    char name[SETTINGS_MAX_NAME_LEN + 1];
+
+    id_name(name, id);
+
+    const struct record *rec = find_record(nvs_store, name);
+    if (rec == NULL) {
+        return -ENOENT;
+    }
+
+    memcpy(data, rec->value, MIN(len, rec->len));
+    return rec->len;
+}
+
+struct read_ctx {
+    const struct record *setting;
+    size_t offset;
+};
+
+static ssize_t read_setting(void *cb_arg, void *data, size_t len) {
+    struct read_ctx *ctx = cb_arg;
+    size_t n = MIN(len, ctx->setting->len - ctx->offset);
+
+    memcpy(data, ctx->setting->value + ctx->offset, n);
+    ctx->offset += n;
+
+    return n;
+}
+
+int settings_load_subtree_direct(const char *subtree, settings_load_direct_cb cb, void *param) {
+    size_t prefix = strlen(subtree);
+
+    store_init();
+
+    for (int i = 0; i < store->count; i++) {
+        const char *name = store->entries[i].name;
+        const char *key;
+
+        if (strncmp(name, subtree, prefix) != 0) {
+            continue;
+        }
+        if (name[prefix] == '/') {
+            key = &name[prefix + 1];
+        } else if (name[prefix] == '\0') {
+            key = NULL;
+        } else {
+            continue;
+        }
+
+        struct read_ctx ctx = {.setting = &store->entries[i]};
+
+        fake_name_bytes += strlen(name);
+        cb(key, store->entries[i].len, read_setting, &ctx, param);
+    }
+
+    return 0;
+}
+
+int settings_load_subtree(const char *subtree) { return 0; }
+
+int settings_name_next(const char *name, const char **next) {
+    const char *sep = strchr(name, '/');
+
+    if (next != NULL) {
+        *next = sep != NULL ? sep + 1 : NULL;
+    }
+
+    return sep != NULL ? sep - name : (int)strlen(name);
+}
+
+int settings_name_steq(const char *name, const char *key, const char **next) {
+    size_t len = strlen(key);
+
+    if (next != NULL) {
+        *next = NULL;
+    }
+    if (strncmp(name, key, len) != 0) {
+        return 0;
+    }
+    if (name[len] == '/') {
+        if (next != NULL) {
+            *next = &name[len + 1];
+        }
+        return 1;
+    }
+
+    return name[len] == '\0';
+}
+
+/* Power cycles */
+
+void *fake_noinit(size_t size) {
+    static void *noinit;
+    static size_t noinit_size;
+
+    if (noinit == NULL) {
+        noinit_size = size;
+        noinit = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (noinit == MAP_FAILED) {
+            perror("mmap");
+            exit(2);
+        }
+    }
+    if (size > noinit_size) {
+        fprintf(stderr, "fake_noinit: size changed\n");
+        exit(2);
+    }
+
+    return noinit;
+}
+
+void fake_boot(void (*fn)(void)) {
+    int status;
+
+    /* The store must exist before the fork to be shared */
+    store_init();
+    fflush(NULL);
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        exit(2);
+    }
+    if (pid == 0) {
+        fn();
+        fflush(NULL);
+        _exit(fake_check_result());
+    }
+
+    if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        failed_checks++;
+    }
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <stdbool.h>
+
+/**
+ * @brief Controls of the host fakes
+ *
+ * Time only moves when a test sets fake_now. Settings live in memory for
+ * the whole test run.
+ */
+
+/**
+ * @brief Run one power cycle of the keyboard
+ *
+ * fn runs in a child process, so the module starts from its static
+ * initial state while the settings written by earlier boots are kept.
+ * Failed checks in fn count towards fake_check_result().
+ */
+void fake_boot(void (*fn)(void));
+
+/**
+ * @brief Memory that keeps its contents across fake_boot() calls
+ *
+ * Stands in for .noinit RAM surviving a warm reset: copy a block here at
+ * the end of one boot and back at the start of the next. The first call
+ * must come before the first fake_boot().
+ */
+void *fake_noinit(size_t size);
+
+struct k_work_delayable;
+
+/* Run a scheduled work item now, returns false if it was not scheduled */
+bool fake_work_run(struct k_work_delayable *dwork);
+
+/* Value returned by k_uptime_get() */
+extern int64_t fake_now;
+
+/* Successful settings writes so far */
+extern int fake_settings_writes;
+
+/* NVS writes so far, not counting data equal to what was stored */
+extern int fake_store_writes;
+
+/* Let this many more settings or store writes succeed, then fail all of them */
+extern int fake_settings_writes_left;
+
+/*
+ * Flash bytes written by settings and NVS writes and deletes: the data plus
+ * an 8-byte allocation table entry per record, and for settings a name
+ * record whenever a new key is written
+ */
+extern size_t fake_flash_bytes;
+
+/* Bytes of settings key strings written, deleted or loaded */
+extern size_t fake_name_bytes;
+
+/* Whether a setting is stored */
+bool fake_settings_exists(const char *name);
+
+/* Number of stored settings */
+int fake_settings_count(void);
+
+/* Remove every stored setting and NVS record */
+void fake_settings_clear(void);
+
+/* Store a setting as if an older firmware had written it */
+int fake_settings_set(const char *name, const void *value, size_t len);
+
+/* Copy a stored setting into value, returns its length or -ENOENT */
+int fake_settings_get(const char *name, void *value, size_t size);
+
+/* Copy an NVS record into value, returns its length or -ENOENT */
+int fake_store_get(uint16_t id, void *value, size_t size);
+
+/* Number of NVS records */
+int fake_store_count(void);
+
+/* Remove every NVS record */
+void fake_store_clear(void);
+
+/* Failed checks print where and set a non-zero exit status */
+#define CHECK(cond)                                                                                \
+    do {                                                                                           \
+        if (!(cond)) {                                                                             \
+            fake_check_failed(__FILE__, __LINE__, #cond);                                          \
+        }                                                                                          \
+    } while (0)
+
+void fake_check_failed(const char *file, int line, const char *cond);
+
+/* Exit status for main() */
+int fake_check_result(void);
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/* The LVGL 8 chart API used by the Prospector widgets, fakes in the tests */
+
+typedef int16_t lv_coord_t;
+typedef uint8_t lv_opa_t;
+typedef uint32_t lv_style_selector_t;
+
+typedef struct {
+    uint32_t full;
+} lv_color_t;
+
+typedef struct lv_obj lv_obj_t;
+typedef struct lv_chart_series lv_chart_series_t;
+
+#define LV_OPA_TRANSP 0
+#define LV_PART_MAIN 0
+
+typedef enum {
+    LV_CHART_TYPE_NONE,
+    LV_CHART_TYPE_LINE,
+    LV_CHART_TYPE_BAR,
+} lv_chart_type_t;
+
+typedef enum {
+    LV_CHART_UPDATE_MODE_SHIFT,
+    LV_CHART_UPDATE_MODE_CIRCULAR,
+} lv_chart_update_mode_t;
+
+typedef enum {
+    LV_CHART_AXIS_PRIMARY_Y,
+} lv_chart_axis_t;
+
+static inline lv_color_t lv_color_hex(uint32_t c) { return (lv_color_t){.full = c}; }
+
+void lv_obj_set_size(lv_obj_t *obj, lv_coord_t w, lv_coord_t h);
+void lv_obj_set_style_bg_opa(lv_obj_t *obj, lv_opa_t value, lv_style_selector_t selector);
+void lv_obj_set_style_border_width(lv_obj_t *obj, lv_coord_t value,
+                                   lv_style_selector_t selector);
+void lv_obj_set_style_pad_all(lv_obj_t *obj, lv_coord_t value, lv_style_selector_t selector);
+
+lv_obj_t *lv_chart_create(lv_obj_t *parent);
+void lv_chart_set_div_line_count(lv_obj_t *obj, uint8_t hdiv, uint8_t vdiv);
+void lv_chart_set_type(lv_obj_t *obj, lv_chart_type_t type);
+void lv_chart_set_update_mode(lv_obj_t *obj, lv_chart_update_mode_t update_mode);
+void lv_chart_set_point_count(lv_obj_t *obj, uint16_t cnt);
+void lv_chart_set_range(lv_obj_t *obj, lv_chart_axis_t axis, lv_coord_t min, lv_coord_t max);
+lv_chart_series_t *lv_chart_add_series(lv_obj_t *obj, lv_color_t color, lv_chart_axis_t axis);
+void lv_chart_set_ext_y_array(lv_obj_t *obj, lv_chart_series_t *ser, lv_coord_t array[]);
+void lv_chart_set_x_start_point(lv_obj_t *obj, lv_chart_series_t *ser, uint16_t id);
+void lv_chart_set_next_value(lv_obj_t *obj, lv_chart_series_t *ser, lv_coord_t value);
+void lv_chart_refresh(lv_obj_t *obj);
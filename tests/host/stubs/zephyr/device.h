@@ -0,0 +1,21 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <zephyr/devicetree.h>
+
+struct device {
+    const char *name;
+};
+
+bool device_is_ready(const struct device *dev);
+
+/* Every devicetree node is the same fake device */
+extern const struct device fake_device;
+
+#define DEVICE_DT_GET(node) (&fake_device)
@@ -0,0 +1,11 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#define DT_CHOSEN(prop) 0
+#define DT_HAS_CHOSEN(prop) 1
+#define DT_HAS_COMPAT_STATUS_OKAY(compat) 1
@@ -0,0 +1,10 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+/* Tests call init functions themselves */
+#define SYS_INIT(fn, level, prio) static const void *const __init_##fn __attribute__((used)) = fn
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/* Host stand-in for the parts of the Zephyr kernel API the module uses */
+
+#pragma once
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/init.h>
+
+typedef struct {
+    int64_t ticks;
+} k_timeout_t;
+
+#define K_MSEC(ms) ((k_timeout_t){(ms)})
+#define K_SECONDS(s) ((k_timeout_t){(s) * 1000})
+#define K_TICKS(t) ((k_timeout_t){(t)})
+#define K_FOREVER ((k_timeout_t){-1})
+#define K_NO_WAIT ((k_timeout_t){0})
+
+int64_t k_uptime_get(void);
+uint32_t k_uptime_get_32(void);
+int64_t k_uptime_delta(int64_t *reftime);
+uint32_t k_cycle_get_32(void);
+uint64_t k_cyc_to_us_floor64(uint64_t cycles);
+uint32_t k_cyc_to_us_floor32(uint32_t cycles);
+uint64_t k_cyc_to_ns_floor64(uint64_t cycles);
+
+/* Tests are single threaded, locks only count how deep they are held */
+struct k_mutex {
+    int lock_count;
+};
+
+#define K_MUTEX_DEFINE(name) struct k_mutex name
+
+int k_mutex_init(struct k_mutex *mutex);
+int k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout);
+int k_mutex_unlock(struct k_mutex *mutex);
+
+struct k_spinlock {
+    int unused;
+};
+
+typedef struct {
+    int key;
+} k_spinlock_key_t;
+
+k_spinlock_key_t k_spin_lock(struct k_spinlock *lock);
+void k_spin_unlock(struct k_spinlock *lock, k_spinlock_key_t key);
+
+/*
+ * Work items are never run by the fakes, tests call the handlers directly
+ * or use fake_work_run(). Delayable work only tracks whether it is
+ * scheduled, and with what delay.
+ */
+struct k_work;
+typedef void (*k_work_handler_t)(struct k_work *work);
+
+struct k_work {
+    k_work_handler_t handler;
+};
+
+struct k_work_delayable {
+    struct k_work work;
+    bool pending;
+    int64_t delay_ms;
+};
+
+struct k_work_q {
+    int unused;
+};
+
+struct k_work_queue_config {
+    const char *name;
+    bool no_yield;
+    bool essential;
+};
+
+#define K_WORK_DEFINE(name, handler) struct k_work name = {handler}
+#define K_WORK_DELAYABLE_DEFINE(name, handler) struct k_work_delayable name = {{handler}}
+
+void k_work_init(struct k_work *work, k_work_handler_t handler);
+void k_work_init_delayable(struct k_work_delayable *dwork, k_work_handler_t handler);
+int k_work_submit(struct k_work *work);
+int k_work_submit_to_queue(struct k_work_q *queue, struct k_work *work);
+int k_work_schedule(struct k_work_delayable *dwork, k_timeout_t delay);
+int k_work_schedule_for_queue(struct k_work_q *queue, struct k_work_delayable *dwork,
+                              k_timeout_t delay);
+int k_work_reschedule(struct k_work_delayable *dwork, k_timeout_t delay);
+int k_work_reschedule_for_queue(struct k_work_q *queue, struct k_work_delayable *dwork,
+                                k_timeout_t delay);
+int k_work_cancel_delayable(struct k_work_delayable *dwork);
+bool k_work_delayable_is_pending(const struct k_work_delayable *dwork);
+struct k_work_delayable *k_work_delayable_from_work(struct k_work *work);
+void k_work_queue_init(struct k_work_q *queue);
+void k_work_queue_start(struct k_work_q *queue, void *stack, size_t stack_size, int prio,
+                        const struct k_work_queue_config *cfg);
+
+#define K_THREAD_STACK_DEFINE(name, size) char name[size]
+#define K_THREAD_STACK_SIZEOF(name) sizeof(name)
+#define K_LOWEST_APPLICATION_THREAD_PRIO 14
+#define K_PRIO_PREEMPT(prio) (prio)
+#define k_work_queue_thread_get(queue) ((void *)(queue))
+
+void k_thread_name_set(void *thread, const char *name);
+
+struct k_timer {
+    int unused;
+};
+
+#define K_TIMER_DEFINE(name, expiry, stop) struct k_timer name
+
+void k_timer_init(struct k_timer *timer, void (*expiry)(struct k_timer *),
+                  void (*stop)(struct k_timer *));
+void k_timer_start(struct k_timer *timer, k_timeout_t duration, k_timeout_t period);
+void k_timer_stop(struct k_timer *timer);
+uint32_t k_timer_remaining_get(struct k_timer *timer);
+int64_t k_timer_remaining_ticks(struct k_timer *timer);
+
+#define __packed __attribute__((packed))
+#define __aligned(x) __attribute__((aligned(x)))
+#define __noinit
+#define __unused __attribute__((unused))
+#define __ASSERT(cond, ...)
+#define __ASSERT_NO_MSG(cond)
+#define BUILD_ASSERT(cond, ...) _Static_assert(cond, "")
+
+static inline unsigned int find_msb_set(uint32_t op) {
+    return op ? 32 - __builtin_clz(op) : 0;
+}
@@ -0,0 +1,19 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+/* Arguments are still evaluated, so values used only in logs stay used */
+static inline void log_discard(int unused, ...) {}
+
+#define LOG_MODULE_REGISTER(...)
+#define LOG_MODULE_DECLARE(...)
+#define LOG_ERR(...) log_discard(0, __VA_ARGS__)
+#define LOG_WRN(...) log_discard(0, __VA_ARGS__)
+#define LOG_INF(...) log_discard(0, __VA_ARGS__)
+#define LOG_DBG(...) log_discard(0, __VA_ARGS__)
+#define LOG_HEXDUMP_INF(...) log_discard(0, __VA_ARGS__)
+#define LOG_HEXDUMP_DBG(...) log_discard(0, __VA_ARGS__)
@@ -0,0 +1,28 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#define SETTINGS_MAX_NAME_LEN 32
+
+typedef ssize_t (*settings_read_cb)(void *cb_arg, void *data, size_t len);
+typedef int (*settings_load_direct_cb)(const char *key, size_t len, settings_read_cb read_cb,
+                                       void *cb_arg, void *param);
+
+int settings_name_next(const char *name, const char **next);
+int settings_name_steq(const char *name, const char *key, const char **next);
+int settings_save_one(const char *name, const void *value, size_t val_len);
+int settings_delete(const char *name);
+int settings_load_subtree(const char *subtree);
+int settings_load_subtree_direct(const char *subtree, settings_load_direct_cb cb, void *param);
+
+/* Handlers are never registered, tests call the module's load functions */
+#define SETTINGS_STATIC_HANDLER_DEFINE(name, subtree, get, set, commit, export)                    \
+    static void *const __settings_##name[] __attribute__((used)) = {                               \
+        (void *)(get), (void *)(set), (void *)(commit), (void *)(export)}
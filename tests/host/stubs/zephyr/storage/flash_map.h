@@ -0,0 +1,14 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zephyr/device.h>
+
+/* Every partition is eight 4 KB pages of the fake device */
+#define FIXED_PARTITION_DEVICE(label) (&fake_device)
+#define FIXED_PARTITION_OFFSET(label) 0
+#define FIXED_PARTITION_SIZE(label) (8 * 4096)
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+/* Tests are single threaded */
+typedef long atomic_t;
+typedef long atomic_val_t;
+
+static inline atomic_val_t atomic_get(const atomic_t *target) {
+    return *target;
+}
+
+static inline atomic_val_t atomic_set(atomic_t *target, atomic_val_t value) {
+    atomic_val_t old = *target;
+
+    *target = value;
+    return old;
+}
+
+static inline atomic_val_t atomic_clear(atomic_t *target) {
+    return atomic_set(target, 0);
+}
+
+static inline atomic_val_t atomic_add(atomic_t *target, atomic_val_t value) {
+    atomic_val_t old = *target;
+
+    *target += value;
+    return old;
+}
+
+static inline atomic_val_t atomic_inc(atomic_t *target) {
+    return atomic_add(target, 1);
+}
+
+static inline atomic_val_t atomic_or(atomic_t *target, atomic_val_t value) {
+    atomic_val_t old = *target;
+
+    *target |= value;
+    return old;
+}
+
+static inline bool atomic_cas(atomic_t *target, atomic_val_t old_value, atomic_val_t new_value) {
+    if (*target != old_value) {
+        return false;
+    }
+
+    *target = new_value;
+    return true;
+}
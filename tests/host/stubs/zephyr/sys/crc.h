@@ -0,0 +1,13 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+uint32_t crc32_ieee(const uint8_t *data, size_t len);
+uint32_t crc32_ieee_update(uint32_t crc, const uint8_t *data, size_t len);
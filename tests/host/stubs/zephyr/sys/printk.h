@@ -0,0 +1,11 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+int snprintk(char *str, size_t size, const char *fmt, ...);
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct _snode {
+    struct _snode *next;
+} sys_snode_t;
+
+typedef struct {
+    sys_snode_t *head;
+    sys_snode_t *tail;
+} sys_slist_t;
+
+#define SYS_SLIST_STATIC_INIT(list) {NULL, NULL}
+
+static inline void sys_slist_init(sys_slist_t *list) {
+    list->head = NULL;
+    list->tail = NULL;
+}
+
+static inline bool sys_slist_is_empty(sys_slist_t *list) {
+    return list->head == NULL;
+}
+
+static inline void sys_slist_append(sys_slist_t *list, sys_snode_t *node) {
+    node->next = NULL;
+    if (list->tail != NULL) {
+        list->tail->next = node;
+    } else {
+        list->head = node;
+    }
+    list->tail = node;
+}
+
+static inline bool sys_slist_find(sys_slist_t *list, sys_snode_t *node, sys_snode_t **prev) {
+    sys_snode_t *p = NULL;
+
+    for (sys_snode_t *cur = list->head; cur != NULL; p = cur, cur = cur->next) {
+        if (cur == node) {
+            if (prev != NULL) {
+                *prev = p;
+            }
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static inline bool sys_slist_find_and_remove(sys_slist_t *list, sys_snode_t *node) {
+    sys_snode_t *prev;
+
+    if (!sys_slist_find(list, node, &prev)) {
+        return false;
+    }
+
+    if (prev != NULL) {
+        prev->next = node->next;
+    } else {
+        list->head = node->next;
+    }
+    if (list->tail == node) {
+        list->tail = prev;
+    }
+    node->next = NULL;
+
+    return true;
+}
+
+#define SYS_SLIST_CONTAINER(ln, cn, n) \
+    ((ln) != NULL ? (__typeof__(cn))((char *)(ln) - offsetof(__typeof__(*(cn)), n)) : NULL)
+
+#define SYS_SLIST_FOR_EACH_CONTAINER(list, cn, n)                                                  \
+    for (cn = SYS_SLIST_CONTAINER((list)->head, cn, n); cn != NULL;                                \
+         cn = SYS_SLIST_CONTAINER((cn)->n.next, cn, n))
+
+#define SYS_SLIST_FOR_EACH_CONTAINER_SAFE(list, cn, cns, n)                                        \
+    for (cn = SYS_SLIST_CONTAINER((list)->head, cn, n),                                            \
+        cns = cn != NULL ? SYS_SLIST_CONTAINER((cn)->n.next, cn, n) : NULL;                        \
+         cn != NULL; cn = cns, cns = cn != NULL ? SYS_SLIST_CONTAINER((cn)->n.next, cn, n) : NULL)
@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+#define ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#define CLAMP(val, low, high) MIN(MAX(val, low), high)
+#define IN_RANGE(val, min, max) ((val) >= (min) && (val) <= (max))
+#define DIV_ROUND_UP(n, d) (((n) + (d) - 1) / (d))
+#define ARG_UNUSED(x) (void)(x)
+#define BIT(n) (1UL << (n))
+#define BIT_MASK(n) (BIT(n) - 1UL)
+#define WRITE_BIT(var, bit, set) ((var) = (set) ? ((var) | BIT(bit)) : ((var) & ~BIT(bit)))
+#define CONTAINER_OF(ptr, type, field) ((type *)(((char *)(ptr)) - offsetof(type, field)))
+#define STRINGIFY(x) #x
+
+/* Options are defined to 0 or 1 by the test build */
+#define IS_ENABLED(option) (option)
@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+    int unused;
+} zmk_event_t;
+
+#define ZMK_EV_EVENT_BUBBLE 0
+
+/* as_* and raise_* are provided by each test */
+#define ZMK_EVENT_DECLARE(event)                                                                   \
+    struct event##_event {                                                                         \
+        zmk_event_t header;                                                                        \
+        struct event data;                                                                         \
+    };                                                                                             \
+    struct event *as_##event(const zmk_event_t *eh);                                               \
+    int raise_##event(struct event data);
+
+#define ZMK_EVENT_IMPL(event)
+#define ZMK_LISTENER(name, cb)                                                                     \
+    static int (*const __listener_##name)(const zmk_event_t *) __attribute__((used)) = cb
+#define ZMK_SUBSCRIPTION(name, event)
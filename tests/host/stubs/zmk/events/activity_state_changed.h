@@ -0,0 +1,16 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zmk/event_manager.h>
+#include <zmk/activity.h>
+
+struct zmk_activity_state_changed {
+    enum zmk_activity_state state;
+};
+
+ZMK_EVENT_DECLARE(zmk_activity_state_changed);
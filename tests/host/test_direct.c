@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "keystroke_stats.c"
+
+#include <stdio.h>
+
+#include <zephyr/fs/nvs.h>
+#include <zephyr/settings/settings.h>
+
+#include "fake_zephyr.h"
+
+/* Record IDs and settings keys, as in keystroke_stats_settings.c */
+#define ID_SECTION(idx, slot) (0x10 + (idx) * 2 + (slot))
+#define ID_JOURNAL(seq) (0x100 + (seq))
+#define JOURNAL_RECORDS CONFIG_ZMK_KEYSTROKE_STATS_JOURNAL_MAX_RECORDS
+
+static const char *const section_names[] = {"core", "wpm", "heatmap", "history"};
+
+static struct zmk_position_state_changed key_event;
+
+struct zmk_position_state_changed *as_zmk_position_state_changed(const zmk_event_t *eh) {
+    return &key_event;
+}
+
+int raise_zmk_keystroke_stats_changed(struct zmk_keystroke_stats_changed ev) { return 0; }
+
+static void press(uint32_t position, int times) {
+    for (int i = 0; i < times; i++) {
+        key_event.position = position;
+        key_event.state = true;
+        keystroke_event_listener(NULL);
+    }
+}
+
+static uint32_t key_count(uint32_t position) {
+    uint32_t count = 0;
+
+    zmk_keystroke_stats_get_key_count(position, &count);
+    return count;
+}
+
+static uint32_t total(void) {
+    struct zmk_keystroke_stats stats;
+
+    zmk_keystroke_stats_get(&stats);
+    return stats.total_keystrokes;
+}
+
+static bool has_record(uint16_t id) {
+    uint8_t byte;
+
+    return fake_store_get(id, &byte, sizeof(byte)) > 0;
+}
+
+/* Checkpoint, then two journal records on top of it */
+static void type(void) {
+    keystroke_stats_init();
+
+    press(1, 10);
+    CHECK(keystroke_stats_save_now() == 0);
+    press(2, 5);
+    CHECK(keystroke_stats_save_now() == 0);
+    press(2, 3);
+    CHECK(keystroke_stats_save_now() == 0);
+}
+
+static void check_typed(void) {
+    keystroke_stats_init();
+
+    CHECK(total() == 18);
+    CHECK(key_count(1) == 10);
+    CHECK(key_count(2) == 8);
+}
+
+/* Sections and journal go to the store, settings are left alone */
+
+static void test_round_trip(void) {
+    fake_settings_clear();
+    fake_boot(type);
+
+    CHECK(fake_settings_count() == 0);
+    CHECK(has_record(ID_SECTION(0, 0)));
+    CHECK(has_record(ID_JOURNAL(0)));
+    CHECK(has_record(ID_JOURNAL(1)));
+    CHECK(!has_record(ID_JOURNAL(2)));
+
+    fake_boot(check_typed);
+}
+
+/* Journal records are replayed from the store */
+
+static void check_without_last(void) {
+    keystroke_stats_init();
+
+    CHECK(total() == 15);
+    CHECK(key_count(1) == 10);
+    CHECK(key_count(2) == 5);
+}
+
+static void test_journal(void) {
+    fake_settings_clear();
+    fake_boot(type);
+
+    /* Without the last record only its three keystrokes are lost */
+    nvs_write(NULL, ID_JOURNAL(1), NULL, 0);
+    fake_boot(check_without_last);
+}
+
+/*
+ * Statistics found only in settings are moved: loaded from there, kept
+ * there until the first checkpoint in the store, then removed.
+ */
+
+#define VALUE_MAX 2048
+
+static uint8_t value[VALUE_MAX];
+
+/* Stand in for statistics saved before the direct backend was enabled */
+static void move_to_settings(void) {
+    char name[SETTINGS_MAX_NAME_LEN + 1];
+    int len;
+
+    for (int i = 0; i < ARRAY_SIZE(section_names); i++) {
+        for (int slot = 0; slot < 2; slot++) {
+            len = fake_store_get(ID_SECTION(i, slot), value, sizeof(value));
+            if (len < 0) {
+                continue;
+            }
+            CHECK(len <= VALUE_MAX);
+            snprintf(name, sizeof(name), "keystroke_stats/%s%s", section_names[i],
+                     slot ? "/b" : "");
+            fake_settings_set(name, value, len);
+        }
+    }
+
+    for (int seq = 0; seq < JOURNAL_RECORDS; seq++) {
+        len = fake_store_get(ID_JOURNAL(seq), value, sizeof(value));
+        if (len < 0) {
+            continue;
+        }
+        snprintf(name, sizeof(name), "keystroke_stats/j/%d", seq);
+        fake_settings_set(name, value, len);
+    }
+
+    fake_store_clear();
+}
+
+static int moved_records;
+
+static void failed_checkpoint(void) {
+    keystroke_stats_init();
+
+    CHECK(total() == 18);
+    fake_settings_writes_left = 0;
+    CHECK(keystroke_stats_save_now() < 0);
+    fake_settings_writes_left = -1;
+}
+
+static void first_checkpoint(void) {
+    keystroke_stats_init();
+
+    CHECK(total() == 18);
+    CHECK(key_count(2) == 8);
+    CHECK(fake_settings_count() == moved_records);
+
+    CHECK(keystroke_stats_save_now() == 0);
+    CHECK(fake_settings_count() == 0);
+    CHECK(has_record(ID_SECTION(0, 0)));
+}
+
+static void test_move(void) {
+    fake_settings_clear();
+    fake_boot(type);
+    move_to_settings();
+    moved_records = fake_settings_count();
+    CHECK(fake_settings_get("keystroke_stats/core", value, sizeof(value)) > 0);
+    CHECK(fake_settings_get("keystroke_stats/j/1", value, sizeof(value)) > 0);
+
+    /* Nothing checkpointed in the store yet, the settings records stay */
+    fake_boot(failed_checkpoint);
+    CHECK(fake_settings_count() == moved_records);
+    CHECK(!has_record(ID_SECTION(0, 0)) && !has_record(ID_SECTION(0, 1)));
+
+    fake_boot(first_checkpoint);
+    fake_boot(check_typed);
+
+    /* Loading from the store again, nothing left to remove */
+    size_t flash_bytes = fake_flash_bytes;
+
+    fake_boot(check_typed);
+    CHECK(fake_settings_count() == 0);
+    CHECK(fake_flash_bytes == flash_bytes);
+}
+
+int main(void) {
+    test_round_trip();
+    test_journal();
+    test_move();
+
+    return fake_check_result();
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "keystroke_stats.c"
+
+#include "fake_zephyr.h"
+
+#define DELTA CONFIG_ZMK_KEYSTROKE_STATS_EVENT_KEYSTROKE_DELTA
+#define MIN_INTERVAL CONFIG_ZMK_KEYSTROKE_STATS_EVENT_MIN_INTERVAL_MS
+#define KEY_INTERVAL_MS 100
+
+static struct zmk_position_state_changed key_event;
+
+struct zmk_position_state_changed *as_zmk_position_state_changed(const zmk_event_t *eh) {
+    return &key_event;
+}
+
+static struct zmk_keystroke_stats_changed raised;
+static int raised_count;
+
+int raise_zmk_keystroke_stats_changed(struct zmk_keystroke_stats_changed ev) {
+    raised = ev;
+    raised_count++;
+    return 0;
+}
+
+static void type(int keys) {
+    for (int i = 0; i < keys; i++) {
+        fake_now += KEY_INTERVAL_MS;
+        key_event.position = 1;
+        key_event.state = true;
+        keystroke_event_listener(NULL);
+    }
+}
+
+/* Run the event work if scheduled, returns whether an event was raised */
+static bool raise_pending(void) {
+    int before = raised_count;
+
+    fake_work_run(&changed_event_work);
+    return raised_count > before;
+}
+
+static void check_payload(void) {
+    CHECK(raised.total_keystrokes == state.total_keystrokes);
+    CHECK(raised.today_keystrokes == state.today_keystrokes);
+    CHECK(raised.yesterday_keystrokes == state.yesterday_keystrokes);
+    CHECK(raised.session_keystrokes == state.session_keystrokes);
+    CHECK(raised.current_wpm == state.current_wpm);
+    CHECK(raised.peak_wpm == state.peak_wpm);
+    CHECK(raised.day == state.current_uptime_day);
+}
+
+int main(void) {
+    fake_now = 1000;
+    keystroke_stats_init();
+
+    /* The first change raises an event with every field marked */
+    type(1);
+    CHECK(k_work_delayable_is_pending(&changed_event_work));
+    CHECK(raise_pending());
+    CHECK(raised.changed == ZMK_KEYSTROKE_STATS_CHANGED_ALL);
+    CHECK(raised.total_keystrokes == 1);
+    check_payload();
+
+    /* Fewer keystrokes than the delta are held back */
+    type(DELTA - 1);
+    CHECK(!k_work_delayable_is_pending(&changed_event_work));
+
+    /* The delta is reached within the minimum interval, the event waits for its end */
+    int64_t last_ms = fake_now - (DELTA - 1) * KEY_INTERVAL_MS;
+    type(1);
+    CHECK(k_work_delayable_is_pending(&changed_event_work));
+    CHECK(changed_event_work.delay_ms == last_ms + MIN_INTERVAL - fake_now);
+
+    /* Keystrokes until then fold into the same event */
+    type(5);
+    CHECK(raise_pending());
+    CHECK(raised_count == 2);
+    CHECK(raised.changed == (ZMK_KEYSTROKE_STATS_CHANGED_TODAY | ZMK_KEYSTROKE_STATS_CHANGED_TOTAL |
+                             ZMK_KEYSTROKE_STATS_CHANGED_SESSION | ZMK_KEYSTROKE_STATS_CHANGED_WPM));
+    CHECK(raised.total_keystrokes == DELTA + 6);
+    CHECK(raised.session_keystrokes == DELTA + 6);
+    CHECK(raised.current_wpm > 0 && raised.peak_wpm >= raised.current_wpm);
+    check_payload();
+
+    /* Going idle raises what is left below the delta */
+    type(3);
+    CHECK(!k_work_delayable_is_pending(&changed_event_work));
+    fake_now += MIN_INTERVAL;
+    keystroke_stats_set_active(false);
+    CHECK(k_work_delayable_is_pending(&changed_event_work));
+    CHECK(changed_event_work.delay_ms == 0);
+    CHECK(raise_pending());
+    CHECK(raised.changed & ZMK_KEYSTROKE_STATS_CHANGED_TOTAL);
+    CHECK(!(raised.changed & ZMK_KEYSTROKE_STATS_CHANGED_DAY));
+    CHECK(raised.total_keystrokes == DELTA + 9);
+    check_payload();
+
+    /* Nothing changed, nothing raised */
+    keystroke_stats_set_active(false);
+    CHECK(!raise_pending());
+
+    /* A day rollover is raised with a single keystroke, the one that noticed it */
+    uint32_t today = state.today_keystrokes;
+    fake_now += 24 * 3600 * 1000LL;
+    type(1);
+    CHECK(k_work_delayable_is_pending(&changed_event_work));
+    CHECK(raise_pending());
+    CHECK(raised.changed & ZMK_KEYSTROKE_STATS_CHANGED_DAY);
+    CHECK(raised.changed & ZMK_KEYSTROKE_STATS_CHANGED_YESTERDAY);
+    CHECK(raised.yesterday_keystrokes == today + 1);
+    CHECK(raised.today_keystrokes == 0);
+    check_payload();
+
+    /* So is a reset, even if only yesterday changes */
+    fake_now += MIN_INTERVAL;
+    zmk_keystroke_stats_reset(false);
+    CHECK(k_work_delayable_is_pending(&changed_event_work));
+    CHECK(raise_pending());
+    CHECK(raised.changed ==
+          (ZMK_KEYSTROKE_STATS_CHANGED_YESTERDAY | ZMK_KEYSTROKE_STATS_CHANGED_SESSION));
+    CHECK(raised.yesterday_keystrokes == 0);
+    check_payload();
+
+    return fake_check_result();
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "keystroke_stats_format.c"
+
+#include "fake_zephyr.h"
+
+#define WIDTH ZMK_KEYSTROKE_STATS_COUNT_WIDTH
+
+static bool formats_as(uint32_t value, const char *expected) {
+    char buf[ZMK_KEYSTROKE_STATS_COUNT_STR_LEN];
+    size_t len = zmk_keystroke_stats_format_count(value, buf, sizeof(buf));
+
+    return len == strlen(expected) && strcmp(buf, expected) == 0;
+}
+
+static bool pads_as(uint32_t value, size_t width, const char *expected) {
+    char buf[16];
+    size_t len = zmk_keystroke_stats_format_count_padded(value, buf, sizeof(buf), width);
+
+    return len == strlen(expected) && strcmp(buf, expected) == 0;
+}
+
+int main(void) {
+    char buf[ZMK_KEYSTROKE_STATS_COUNT_STR_LEN];
+
+    /* Boundaries of each range */
+    CHECK(formats_as(0, "0"));
+    CHECK(formats_as(9, "9"));
+    CHECK(formats_as(10, "10"));
+    CHECK(formats_as(9999, "9999"));
+    CHECK(formats_as(10000, "10K"));
+    CHECK(formats_as(10099, "10K"));
+    CHECK(formats_as(10100, "10.1K"));
+    CHECK(formats_as(12345, "12.3K"));
+    CHECK(formats_as(99999, "99.9K"));
+    CHECK(formats_as(999999, "999.9K"));
+    CHECK(formats_as(1000000, "1M"));
+    CHECK(formats_as(1250000, "1.2M"));
+    CHECK(formats_as(999999999, "999.9M"));
+    CHECK(formats_as(1000000000, "1G"));
+    CHECK(formats_as(UINT32_MAX, "4.2G"));
+
+    /* Too small a buffer gets an empty string, not a cut number */
+    CHECK(zmk_keystroke_stats_format_count(12345, buf, 5) == 0 && buf[0] == '\0');
+    CHECK(zmk_keystroke_stats_format_count(12345, buf, 6) == 5);
+    CHECK(zmk_keystroke_stats_format_count(999999, buf, 6) == 0 && buf[0] == '\0');
+    CHECK(zmk_keystroke_stats_format_count(0, buf, 1) == 0 && buf[0] == '\0');
+    buf[0] = 'x';
+    CHECK(zmk_keystroke_stats_format_count(0, buf, 0) == 0 && buf[0] == 'x');
+
+    /* Fixed width */
+    CHECK(pads_as(0, WIDTH, "     0"));
+    CHECK(pads_as(9999, WIDTH, "  9999"));
+    CHECK(pads_as(12345, WIDTH, " 12.3K"));
+    CHECK(pads_as(999999, WIDTH, "999.9K"));
+    CHECK(pads_as(UINT32_MAX, WIDTH, "  4.2G"));
+    CHECK(pads_as(1234, 0, "1234"));
+    CHECK(pads_as(1234, 2, "1234"));
+    CHECK(zmk_keystroke_stats_format_count_padded(0, buf, WIDTH, WIDTH) == 0 && buf[0] == '\0');
+    CHECK(zmk_keystroke_stats_format_count_padded(0, buf, sizeof(buf), WIDTH) == WIDTH);
+
+    return fake_check_result();
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "keystroke_stats_settings.c"
+
+#include <zmk/events/position_state_changed.h>
+#include <zmk/events/keystroke_stats_changed.h>
+
+#include "fake_zephyr.h"
+
+#define NUM_KEYS CONFIG_ZMK_KEYSTROKE_STATS_MAX_KEY_POSITIONS
+
+struct zmk_position_state_changed *as_zmk_position_state_changed(const zmk_event_t *eh) {
+    return NULL;
+}
+
+int raise_zmk_keystroke_stats_changed(struct zmk_keystroke_stats_changed ev) { return 0; }
+
+static struct keystroke_stats_state in;
+static struct keystroke_stats_state out;
+static union section_payload payload;
+
+/* Encode in, decode into out, return the stream length */
+static size_t round_trip(void) {
+    size_t len = heatmap_encode(&in, &payload);
+
+    CHECK(len <= sizeof(payload.heatmap));
+    memset(out.key_counts, 0xa5, sizeof(out.key_counts));
+    CHECK(heatmap_decode(&out, &payload, len, 2) == 0);
+    CHECK(memcmp(out.key_counts, in.key_counts, sizeof(in.key_counts)) == 0);
+
+    return len;
+}
+
+static void test_zeros(void) {
+    memset(in.key_counts, 0, sizeof(in.key_counts));
+
+    /* Trailing zeros are implied */
+    CHECK(round_trip() == 0);
+}
+
+static void test_sparse(void) {
+    memset(in.key_counts, 0, sizeof(in.key_counts));
+    in.key_counts[3] = 100;
+    in.key_counts[40] = 7;
+
+    /*
+     * Run of three zeros (2 bytes), +100 and -100 (2 each), run of 35
+     * zeros (2), +7 and -7 (1 each), the rest implied
+     */
+    CHECK(round_trip() == 10);
+
+    /* A count on the last key turns the trailing zeros into a run */
+    in.key_counts[NUM_KEYS - 1] = 1;
+    CHECK(round_trip() == 10 + 2 + 1);
+}
+
+static void test_max_counts(void) {
+    for (int i = 0; i < NUM_KEYS; i++) {
+        in.key_counts[i] = UINT32_MAX;
+    }
+
+    /* UINT32_MAX is a difference of -1, then one run */
+    CHECK(round_trip() == 1 + 1 + 1);
+
+    in.key_counts[NUM_KEYS / 2] = 0;
+    CHECK(round_trip() == 1 + 2 + 1 + 1 + 2);
+}
+
+/* Every difference as large as it gets: five bytes per key, the whole buffer */
+static void test_worst_case(void) {
+    for (int i = 0; i < NUM_KEYS; i++) {
+        in.key_counts[i] = i % 2 ? 0 : 0x80000000;
+    }
+
+    CHECK(round_trip() == NUM_KEYS * VARINT_MAX_BYTES);
+    CHECK(sizeof(payload.heatmap) == NUM_KEYS * VARINT_MAX_BYTES);
+}
+
+/* A stream cut inside a varint is rejected */
+static void test_truncated(void) {
+    for (int i = 0; i < NUM_KEYS; i++) {
+        in.key_counts[i] = UINT32_MAX - i;
+    }
+
+    size_t len = heatmap_encode(&in, &payload);
+
+    CHECK(!(payload.heatmap[len - 1] & 0x80));
+    CHECK(heatmap_decode(&out, &payload, len, 2) == 0);
+
+    payload.heatmap[len - 1] |= 0x80;
+    CHECK(heatmap_decode(&out, &payload, len, 2) == -EINVAL);
+}
+
+int main(void) {
+    test_zeros();
+    test_sparse();
+    test_max_counts();
+    test_worst_case();
+    test_truncated();
+
+    return fake_check_result();
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "keystroke_stats.c"
+
+#include "fake_zephyr.h"
+
+static struct zmk_position_state_changed key_event;
+
+struct zmk_position_state_changed *as_zmk_position_state_changed(const zmk_event_t *eh) {
+    return &key_event;
+}
+
+int raise_zmk_keystroke_stats_changed(struct zmk_keystroke_stats_changed ev) { return 0; }
+
+static void press(uint32_t position, int times) {
+    for (int i = 0; i < times; i++) {
+        key_event.position = position;
+        key_event.state = true;
+        keystroke_event_listener(NULL);
+    }
+}
+
+static uint32_t key_count(uint32_t position) {
+    uint32_t count = 0;
+
+    zmk_keystroke_stats_get_key_count(position, &count);
+    return count;
+}
+
+static uint32_t total(void) {
+    struct zmk_keystroke_stats stats;
+
+    zmk_keystroke_stats_get(&stats);
+    return stats.total_keystrokes;
+}
+
+/* Records written between checkpoints are replayed on top of the last one */
+
+static void replay_type(void) {
+    keystroke_stats_init();
+
+    press(1, 10);
+    CHECK(keystroke_stats_save_now() == 0);
+    press(2, 5);
+    CHECK(keystroke_stats_save_now() == 0);
+    press(2, 3);
+    CHECK(keystroke_stats_save_now() == 0);
+}
+
+static void replay_check(void) {
+    keystroke_stats_init();
+
+    /* Replayed changes are checkpointed soon */
+    CHECK(k_work_delayable_is_pending(&state.save_work));
+    CHECK(total() == 18);
+    CHECK(key_count(1) == 10);
+    CHECK(key_count(2) == 8);
+
+    /* The save writes a checkpoint, not nothing or a record repeating the deltas */
+    CHECK(!fake_settings_exists("keystroke_stats/core/b"));
+    CHECK(fake_work_run(&state.save_work));
+    CHECK(fake_settings_exists("keystroke_stats/core/b"));
+}
+
+/* The records are stale now, nothing to replay or save */
+static void replay_checkpointed(void) {
+    keystroke_stats_init();
+
+    CHECK(!k_work_delayable_is_pending(&state.save_work));
+    CHECK(total() == 18);
+    CHECK(key_count(1) == 10);
+    CHECK(key_count(2) == 8);
+}
+
+static void test_replay(void) {
+    fake_settings_clear();
+    fake_boot(replay_type);
+    fake_boot(replay_check);
+    fake_boot(replay_checkpointed);
+}
+
+/*
+ * Power lost during a checkpoint, after the heatmap and history but before
+ * core were written. Keystrokes after the next boot must not be journaled
+ * on top of the old core, their heatmap deltas would be skipped on replay.
+ */
+
+static void interrupted_type(void) {
+    keystroke_stats_init();
+
+    press(1, 10);
+    CHECK(keystroke_stats_save_now() == 0);
+    press(2, 5);
+    CHECK(keystroke_stats_save_now() == 0);
+
+    /* Every section is written before core */
+    press(3, 1);
+    keystroke_stats_journal_invalidate();
+    mark_dirty(KEYSTROKE_STATS_SECTIONS_ALL);
+    fake_settings_writes_left = KEYSTROKE_STATS_SECTION_COUNT - 1;
+    CHECK(keystroke_stats_save_now() < 0);
+}
+
+static void interrupted_recover(void) {
+    keystroke_stats_init();
+
+    /* Core is from before the checkpoint, the heatmap from during it */
+    CHECK(total() == 15);
+    CHECK(key_count(1) == 10);
+    CHECK(key_count(2) == 5);
+    CHECK(key_count(3) == 1);
+
+    press(4, 7);
+    CHECK(keystroke_stats_save_now() == 0);
+    press(4, 2);
+    CHECK(keystroke_stats_save_now() == 0);
+}
+
+static void interrupted_check(void) {
+    keystroke_stats_init();
+
+    CHECK(total() == 24);
+    CHECK(key_count(3) == 1);
+    CHECK(key_count(4) == 9);
+}
+
+static void test_interrupted_checkpoint(void) {
+    fake_settings_clear();
+    fake_boot(interrupted_type);
+    fake_boot(interrupted_recover);
+    fake_boot(interrupted_check);
+}
+
+int main(void) {
+    test_replay();
+    test_interrupted_checkpoint();
+
+    return fake_check_result();
+}
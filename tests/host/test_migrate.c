@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "keystroke_stats.c"
+
+#include "fake_zephyr.h"
+
+#define LEGACY_KEY "keystroke_stats/data"
+
+struct zmk_position_state_changed *as_zmk_position_state_changed(const zmk_event_t *eh) {
+    return NULL;
+}
+
+int raise_zmk_keystroke_stats_changed(struct zmk_keystroke_stats_changed ev) { return 0; }
+
+/* Kconfig of the firmware that wrote the legacy record */
+struct legacy_config {
+    uint8_t version;
+    bool wpm;
+    size_t keys;
+    size_t days;
+};
+
+/* Contents of every legacy record, history entries are for the days before */
+#define TOTAL 5000
+#define TODAY 40
+#define YESTERDAY 300
+#define DAY 300
+#define PEAK_WPM 87
+#define TYPING_TIME_MS 123456
+#define HISTORY_COUNT 3
+
+static uint32_t key_value(size_t position) { return 10 * position + 1; }
+static uint32_t history_value(size_t i) { return 100 * (i + 1); }
+
+static uint8_t record[2048];
+static size_t record_len;
+
+static void put(const void *value, size_t len) {
+    memcpy(&record[record_len], value, len);
+    record_len += len;
+}
+
+static void put8(uint8_t value) { put(&value, 1); }
+
+static void put16(uint16_t value) {
+    put8(value);
+    put8(value >> 8);
+}
+
+static void put32(uint32_t value) {
+    put16(value);
+    put16(value >> 16);
+}
+
+/* Same layout as the packed struct zmk_keystroke_stats_persist_data of v1 */
+static void build_record(const struct legacy_config *c) {
+    record_len = 0;
+
+    put8(c->version);
+    put32(TOTAL);
+    put32(TODAY);
+    put32(YESTERDAY);
+    put16(DAY);
+
+    if (c->wpm) {
+        put8(PEAK_WPM);
+        put32(TYPING_TIME_MS);
+    }
+
+    for (size_t i = 0; i < c->keys; i++) {
+        put32(key_value(i));
+    }
+
+    if (c->days > 0) {
+        for (size_t i = 0; i < c->days; i++) {
+            bool used = i < HISTORY_COUNT;
+
+            /* Year and month zero, low byte of the uptime day */
+            put16(0);
+            put8(0);
+            put8(used ? (uint8_t)(DAY - HISTORY_COUNT + i) : 0);
+            put32(used ? history_value(i) : 0);
+        }
+        put8(HISTORY_COUNT);
+    }
+}
+
+/* What the current boot is expected to have recovered */
+static const struct legacy_config *written;
+static bool expect_counters;
+static bool expect_rest;
+
+static void check_stats(void) {
+    struct zmk_keystroke_stats stats;
+
+    CHECK(zmk_keystroke_stats_get(&stats) == 0);
+
+    if (!expect_counters) {
+        CHECK(stats.total_keystrokes == 0);
+        return;
+    }
+
+    CHECK(stats.total_keystrokes == TOTAL);
+    CHECK(stats.today_keystrokes == TODAY);
+    CHECK(stats.yesterday_keystrokes == YESTERDAY);
+    CHECK(stats.current_uptime_day == DAY);
+
+    bool wpm = expect_rest && written->wpm;
+    CHECK(stats.peak_wpm == (wpm ? PEAK_WPM : 0));
+    CHECK(stats.total_typing_time_ms == (wpm ? TYPING_TIME_MS : 0));
+
+    for (uint32_t i = 0; i < CONFIG_ZMK_KEYSTROKE_STATS_MAX_KEY_POSITIONS; i++) {
+        uint32_t count = 0;
+        bool migrated = expect_rest && i < written->keys;
+
+        zmk_keystroke_stats_get_key_count(i, &count);
+        CHECK(count == (migrated ? key_value(i) : 0));
+    }
+
+    CHECK(stats.daily_stats_count == (expect_rest ? HISTORY_COUNT : 0));
+    for (size_t i = 0; i < stats.daily_stats_count; i++) {
+        const struct zmk_keystroke_stats_daily_entry *entry = &stats.daily_stats[i];
+
+        CHECK(entry->day == DAY - HISTORY_COUNT + i);
+        CHECK(zmk_keystroke_stats_daily_entry_get_keystrokes(entry) == history_value(i));
+    }
+}
+
+static void migrate_boot(void) {
+    keystroke_stats_init();
+    check_stats();
+    CHECK(k_work_delayable_is_pending(&state.save_work));
+
+    /* The first checkpoint replaces the legacy record */
+    CHECK(keystroke_stats_save_now() == 0);
+    CHECK(!fake_settings_exists(LEGACY_KEY));
+}
+
+static void migrated_boot(void) {
+    keystroke_stats_init();
+    check_stats();
+    CHECK(!k_work_delayable_is_pending(&state.save_work));
+}
+
+static void test_migration(const struct legacy_config *c, bool counters, bool rest) {
+    written = c;
+    expect_counters = counters;
+    expect_rest = rest;
+
+    build_record(c);
+    fake_settings_clear();
+    fake_settings_set(LEGACY_KEY, record, record_len);
+
+    fake_boot(migrate_boot);
+    fake_boot(migrated_boot);
+}
+
+static void unsupported_boot(void) {
+    keystroke_stats_init();
+    check_stats();
+    CHECK(fake_settings_exists(LEGACY_KEY));
+}
+
+int main(void) {
+    const int keys = CONFIG_ZMK_KEYSTROKE_STATS_MAX_KEY_POSITIONS;
+    const int days = CONFIG_ZMK_KEYSTROKE_STATS_DAILY_HISTORY_DAYS;
+
+    /* Same features as this build */
+    test_migration(&(struct legacy_config){1, true, keys, days}, true, true);
+
+    /* Key count or history length changed, not both */
+    test_migration(&(struct legacy_config){1, true, keys / 2, days}, true, true);
+    test_migration(&(struct legacy_config){1, true, keys, days * 2}, true, true);
+
+    /* WPM disabled in the old build */
+    test_migration(&(struct legacy_config){1, false, keys, days}, true, true);
+
+    /* Layout cannot be worked out, or does not fit the buffer */
+    test_migration(&(struct legacy_config){1, true, keys / 2, days * 2}, true, false);
+    test_migration(&(struct legacy_config){1, true, 256, 30}, true, false);
+
+    /* Versions that were never released are left alone */
+    written = &(struct legacy_config){2, true, keys, days};
+    expect_counters = false;
+    build_record(written);
+    fake_settings_clear();
+    fake_settings_set(LEGACY_KEY, record, record_len);
+    fake_boot(unsupported_boot);
+
+    return fake_check_result();
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "ui/oled/keystroke_stats_oled.c"
+
+#include "fake_zephyr.h"
+
+/* Statistics as seen by the UI */
+static struct zmk_keystroke_stats current;
+static struct zmk_keystroke_stats_subscriber *subscribed;
+
+int zmk_keystroke_stats_get(struct zmk_keystroke_stats *stats) {
+    *stats = current;
+    return 0;
+}
+
+int zmk_keystroke_stats_subscribe(struct zmk_keystroke_stats_subscriber *sub) {
+    subscribed = sub;
+    return 0;
+}
+
+struct zmk_activity_state_changed *as_zmk_activity_state_changed(const zmk_event_t *eh) {
+    return NULL;
+}
+
+/* 128x64 SSD1306 */
+
+static int writes;
+static int failing_writes;
+static uint16_t last_y;
+static uint32_t last_size;
+
+int display_write(const struct device *dev, uint16_t x, uint16_t y,
+                  const struct display_buffer_descriptor *desc, const void *buf) {
+    if (failing_writes > 0) {
+        failing_writes--;
+        return -EIO;
+    }
+
+    writes++;
+    last_y = y;
+    last_size = desc->buf_size;
+    return 0;
+}
+
+int display_blanking_off(const struct device *dev) { return 0; }
+
+void display_get_capabilities(const struct device *dev, struct display_capabilities *caps) {
+    caps->x_resolution = 128;
+    caps->y_resolution = 64;
+    caps->supported_pixel_formats = PIXEL_FORMAT_MONO01 | PIXEL_FORMAT_MONO10;
+    caps->screen_info = SCREEN_INFO_MONO_VTILED;
+    caps->current_pixel_format = PIXEL_FORMAT_MONO01;
+}
+
+int display_set_pixel_format(const struct device *dev, enum display_pixel_format format) {
+    return 0;
+}
+
+/* A statistics change notification followed by the periodic update */
+static void update(void) {
+    subscribed->callback(&current, subscribed->user_data);
+    writes = 0;
+    update_work_handler(NULL);
+}
+
+int main(void) {
+    current.today_keystrokes = 1234;
+    current.yesterday_keystrokes = 987;
+    current.total_keystrokes = 12345;
+
+    CHECK(oled_ui_init() == 0);
+    CHECK(subscribed != NULL);
+
+    /* The first update clears the whole panel */
+    writes = 0;
+    update_work_handler(NULL);
+    CHECK(writes == 8);
+
+    /* One changed row writes its page only */
+    current.today_keystrokes++;
+    update();
+    CHECK(writes == 1);
+    CHECK(last_y == 0);
+    CHECK(last_size == 128);
+
+    /* Rows are on every other page of a 128x64 panel */
+    current.total_keystrokes = 12400;
+    update();
+    CHECK(writes == 1);
+    CHECK(last_y == 4 * PAGE_HEIGHT);
+
+    /* A change that does not show, 12.4K staying 12.4K, writes nothing */
+    current.total_keystrokes++;
+    update();
+    CHECK(writes == 0);
+
+    /* A failed write is retried on the next update, without a change */
+    current.yesterday_keystrokes++;
+    failing_writes = 1;
+    update();
+    CHECK(writes == 0);
+    writes = 0;
+    update_work_handler(NULL);
+    CHECK(writes == 1);
+    CHECK(last_y == 2 * PAGE_HEIGHT);
+
+    return fake_check_result();
+}
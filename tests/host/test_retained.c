@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "keystroke_stats.c"
+#include "keystroke_stats_retained.c"
+
+#include "fake_zephyr.h"
+
+static struct zmk_position_state_changed key_event;
+
+struct zmk_position_state_changed *as_zmk_position_state_changed(const zmk_event_t *eh) {
+    return &key_event;
+}
+
+int raise_zmk_keystroke_stats_changed(struct zmk_keystroke_stats_changed ev) { return 0; }
+
+static void press(uint32_t position, int times) {
+    for (int i = 0; i < times; i++) {
+        key_event.position = position;
+        key_event.state = true;
+        keystroke_event_listener(NULL);
+    }
+}
+
+static uint32_t total(void) {
+    struct zmk_keystroke_stats stats;
+
+    zmk_keystroke_stats_get(&stats);
+    return stats.total_keystrokes;
+}
+
+static struct retained_block *ram;
+
+/* Start with the retained RAM of the previous boot */
+static void warm_boot(void) {
+    memcpy(&retained, ram, sizeof(retained));
+    keystroke_stats_init();
+}
+
+/* Refresh the retained copy and reset before the next save */
+static void warm_reset(void) {
+    retained_sync_handler(NULL);
+    memcpy(ram, &retained, sizeof(retained));
+}
+
+/* Typing after the last save is recovered */
+
+static void unsaved_type(void) {
+    keystroke_stats_init();
+
+    press(1, 10);
+    CHECK(keystroke_stats_save_now() == 0);
+    press(1, 5);
+    warm_reset();
+}
+
+static void unsaved_check(void) {
+    warm_boot();
+
+    CHECK(total() == 15);
+}
+
+/* A reset that reached retained RAM but not flash stays reset */
+
+static void reset_unsaved_type(void) {
+    keystroke_stats_init();
+
+    press(1, 100);
+    CHECK(keystroke_stats_save_now() == 0);
+    CHECK(zmk_keystroke_stats_reset(true) == 0);
+    press(1, 3);
+    warm_reset();
+}
+
+static void reset_unsaved_check(void) {
+    warm_boot();
+
+    CHECK(total() == 3);
+}
+
+/* A saved reset is not undone by an older retained copy */
+
+static void reset_saved_type(void) {
+    keystroke_stats_init();
+
+    press(1, 100);
+    CHECK(keystroke_stats_save_now() == 0);
+    warm_reset();
+    CHECK(zmk_keystroke_stats_reset(true) == 0);
+    press(1, 3);
+    CHECK(keystroke_stats_save_now() == 0);
+}
+
+static void reset_saved_check(void) {
+    warm_boot();
+
+    CHECK(total() == 3);
+}
+
+static void run(void (*type)(void), void (*check)(void)) {
+    fake_settings_clear();
+    memset(ram, 0, sizeof(*ram));
+    fake_boot(type);
+    fake_boot(check);
+}
+
+int main(void) {
+    ram = fake_noinit(sizeof(*ram));
+
+    run(unsaved_type, unsaved_check);
+    run(reset_unsaved_type, reset_unsaved_check);
+    run(reset_saved_type, reset_saved_check);
+
+    return fake_check_result();
+}
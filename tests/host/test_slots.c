@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "keystroke_stats.c"
+
+#include <zephyr/sys/crc.h>
+
+#include "fake_zephyr.h"
+
+#define CORE_A "keystroke_stats/core"
+#define CORE_B "keystroke_stats/core/b"
+
+/* Section trailer: sequence number, reserved, then CRC32 of all before it */
+#define TRAILER_BYTES 8
+#define CRC_BYTES 4
+
+static struct zmk_position_state_changed key_event;
+
+struct zmk_position_state_changed *as_zmk_position_state_changed(const zmk_event_t *eh) {
+    return &key_event;
+}
+
+int raise_zmk_keystroke_stats_changed(struct zmk_keystroke_stats_changed ev) { return 0; }
+
+static void press(uint32_t position, int times) {
+    for (int i = 0; i < times; i++) {
+        key_event.position = position;
+        key_event.state = true;
+        keystroke_event_listener(NULL);
+    }
+}
+
+static uint32_t total(void) {
+    struct zmk_keystroke_stats stats;
+
+    zmk_keystroke_stats_get(&stats);
+    return stats.total_keystrokes;
+}
+
+/* Write every section, each to the slot not holding its newest copy */
+static void checkpoint(void) {
+    keystroke_stats_journal_invalidate();
+    mark_dirty(KEYSTROKE_STATS_SECTIONS_ALL);
+    CHECK(keystroke_stats_save_now() == 0);
+}
+
+/* Core in slot A with 10 keystrokes, in slot B with 15 */
+static void two_checkpoints(void) {
+    keystroke_stats_init();
+
+    press(1, 10);
+    checkpoint();
+    press(1, 5);
+    checkpoint();
+}
+
+static void setup(void) {
+    fake_settings_clear();
+    fake_boot(two_checkpoints);
+}
+
+static uint32_t expected_total;
+
+static void check_total(void) {
+    keystroke_stats_init();
+
+    CHECK(total() == expected_total);
+}
+
+static void expect_total(uint32_t value) {
+    expected_total = value;
+    fake_boot(check_total);
+}
+
+/* The newest copy wins */
+
+static void test_newest(void) {
+    setup();
+    expect_total(15);
+}
+
+/* A copy failing its CRC, or cut short, falls back to the other one */
+
+#define VALUE_MAX 256
+
+static uint8_t value[VALUE_MAX];
+
+static int get(const char *name) {
+    int len = fake_settings_get(name, value, sizeof(value));
+
+    CHECK(len > TRAILER_BYTES && len <= VALUE_MAX);
+    return len;
+}
+
+static void corrupt_crc(const char *name) {
+    int len = get(name);
+
+    /* A payload byte, the CRC itself is intact */
+    value[len - TRAILER_BYTES - 1] ^= 0x40;
+    fake_settings_set(name, value, len);
+}
+
+static void truncate_copy(const char *name, int cut) {
+    int len = get(name);
+
+    fake_settings_set(name, value, len - cut);
+}
+
+static uint8_t good_copy[VALUE_MAX];
+static int good_len;
+
+/* The copy that was loaded is kept, the next checkpoint replaces the bad one */
+static void overwrite_bad(void) {
+    keystroke_stats_init();
+
+    CHECK(total() == 10);
+    press(1, 1);
+    checkpoint();
+}
+
+static void check_good_kept(void) {
+    int len = get(CORE_A);
+
+    CHECK(len == good_len && memcmp(value, good_copy, len) == 0);
+    expect_total(11);
+}
+
+static void test_bad_crc(void) {
+    setup();
+    corrupt_crc(CORE_B);
+    expect_total(10);
+
+    good_len = get(CORE_A);
+    memcpy(good_copy, value, good_len);
+    fake_boot(overwrite_bad);
+    check_good_kept();
+
+    /* The older slot can be the bad one as well */
+    setup();
+    corrupt_crc(CORE_A);
+    expect_total(15);
+
+    /* No good copy, nothing loaded */
+    setup();
+    corrupt_crc(CORE_A);
+    corrupt_crc(CORE_B);
+    expect_total(0);
+}
+
+static void test_truncated(void) {
+    /* Torn inside the trailer */
+    setup();
+    truncate_copy(CORE_B, 3);
+    expect_total(10);
+
+    /* Torn inside the payload */
+    setup();
+    truncate_copy(CORE_B, TRAILER_BYTES + 2);
+    expect_total(10);
+
+    /* Not even a header */
+    setup();
+    truncate_copy(CORE_B, get(CORE_B) - 2);
+    expect_total(10);
+}
+
+/* Sequence numbers compare across the 16-bit wrap */
+
+static void set_seq(const char *name, uint16_t seq) {
+    int len = get(name);
+    uint32_t crc;
+
+    memcpy(&value[len - TRAILER_BYTES], &seq, sizeof(seq));
+    crc = crc32_ieee(value, len - CRC_BYTES);
+    memcpy(&value[len - CRC_BYTES], &crc, sizeof(crc));
+    fake_settings_set(name, value, len);
+}
+
+static uint16_t get_seq(const char *name) {
+    int len = get(name);
+    uint16_t seq;
+
+    memcpy(&seq, &value[len - TRAILER_BYTES], sizeof(seq));
+    return seq;
+}
+
+static void wrapped_save(void) {
+    keystroke_stats_init();
+
+    press(1, 1);
+    checkpoint();
+}
+
+static void test_seq_wrap(void) {
+    /* Newer in slot B, just past the wrap */
+    setup();
+    set_seq(CORE_A, 0xffff);
+    set_seq(CORE_B, 0x0000);
+    expect_total(15);
+
+    /* Newer in slot A, just past the wrap */
+    setup();
+    set_seq(CORE_A, 0x0001);
+    set_seq(CORE_B, 0xfffe);
+    expect_total(10);
+
+    /* Both before the wrap, the next copy goes past it into the other slot */
+    setup();
+    set_seq(CORE_A, 0xfffe);
+    set_seq(CORE_B, 0xffff);
+    expect_total(15);
+    fake_boot(wrapped_save);
+    CHECK(get_seq(CORE_A) == 0x0000);
+    CHECK(get_seq(CORE_B) == 0xffff);
+    expect_total(16);
+}
+
+int main(void) {
+    test_newest();
+    test_bad_crc();
+    test_truncated();
+    test_seq_wrap();
+
+    return fake_check_result();
+}
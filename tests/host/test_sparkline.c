@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "ui/prospector/keystroke_stats_sparkline.c"
+
+#include "fake_zephyr.h"
+
+#define HEIGHT 40
+#define DAY 20100
+
+/* Statistics as seen by the widget */
+static struct zmk_keystroke_stats current;
+
+int zmk_keystroke_stats_get(struct zmk_keystroke_stats *stats) {
+    *stats = current;
+    return 0;
+}
+
+static void set_history(int i, uint16_t day, uint32_t keystrokes) {
+    zmk_keystroke_stats_daily_entry_set(&current.daily_stats[i], day, keystrokes);
+    current.daily_stats_count = MAX(current.daily_stats_count, i + 1);
+}
+
+/* A chart in circular mode: the next value goes to the start point */
+
+struct lv_obj {
+    int unused;
+};
+
+struct lv_chart_series {
+    lv_coord_t *y_points;
+    uint16_t start_point;
+};
+
+static struct lv_obj fake_chart;
+static struct lv_chart_series fake_series;
+static int refreshes;
+static int next_values;
+
+void lv_obj_set_size(lv_obj_t *obj, lv_coord_t w, lv_coord_t h) {}
+void lv_obj_set_style_bg_opa(lv_obj_t *obj, lv_opa_t value, lv_style_selector_t selector) {}
+void lv_obj_set_style_border_width(lv_obj_t *obj, lv_coord_t value,
+                                   lv_style_selector_t selector) {}
+void lv_obj_set_style_pad_all(lv_obj_t *obj, lv_coord_t value, lv_style_selector_t selector) {}
+
+lv_obj_t *lv_chart_create(lv_obj_t *parent) { return &fake_chart; }
+void lv_chart_set_div_line_count(lv_obj_t *obj, uint8_t hdiv, uint8_t vdiv) {}
+void lv_chart_set_type(lv_obj_t *obj, lv_chart_type_t type) {}
+void lv_chart_set_update_mode(lv_obj_t *obj, lv_chart_update_mode_t update_mode) {}
+void lv_chart_set_point_count(lv_obj_t *obj, uint16_t cnt) {}
+void lv_chart_set_range(lv_obj_t *obj, lv_chart_axis_t axis, lv_coord_t min, lv_coord_t max) {}
+
+lv_chart_series_t *lv_chart_add_series(lv_obj_t *obj, lv_color_t color, lv_chart_axis_t axis) {
+    return &fake_series;
+}
+
+void lv_chart_set_ext_y_array(lv_obj_t *obj, lv_chart_series_t *ser, lv_coord_t array[]) {
+    ser->y_points = array;
+}
+
+void lv_chart_set_x_start_point(lv_obj_t *obj, lv_chart_series_t *ser, uint16_t id) {
+    ser->start_point = id;
+}
+
+void lv_chart_set_next_value(lv_obj_t *obj, lv_chart_series_t *ser, lv_coord_t value) {
+    ser->y_points[ser->start_point] = value;
+    ser->start_point = (ser->start_point + 1) % POINTS;
+    next_values++;
+}
+
+void lv_chart_refresh(lv_obj_t *obj) { refreshes++; }
+
+/* Show today's count, counting how it touched the chart */
+static void update(uint16_t day, uint32_t today) {
+    refreshes = 0;
+    next_values = 0;
+    keystroke_stats_sparkline_update(day, today);
+}
+
+int main(void) {
+    /* Yesterday, three days ago, today's own entry and one too old to show */
+    set_history(0, DAY - 1, 300);
+    set_history(1, DAY - 3, 50);
+    set_history(2, DAY, 999);
+    set_history(3, DAY - POINTS, 777);
+
+    CHECK(keystroke_stats_sparkline_create(NULL, 220, HEIGHT) == &fake_chart);
+
+    /* The first update builds the series, scaled to the largest day plus headroom */
+    update(DAY, 100);
+    CHECK(refreshes == 1 && next_values == 0);
+    CHECK(scale_max == 300 + 75);
+    CHECK(points[TODAY_POINT] == 100 * HEIGHT / 375);
+    CHECK(points[TODAY_POINT - 1] == 300 * HEIGHT / 375);
+    CHECK(points[TODAY_POINT - 3] == 50 * HEIGHT / 375);
+    CHECK(points[0] == 0 && points[TODAY_POINT - 2] == 0);
+
+    /* A change of the bar's height in pixels rewrites that bar only */
+    update(DAY, 105);
+    CHECK(refreshes == 0 && next_values == 1);
+    CHECK(points[TODAY_POINT] == 105 * HEIGHT / 375);
+    CHECK(points[TODAY_POINT - 1] == 300 * HEIGHT / 375);
+
+    /* Less than a pixel touches nothing */
+    update(DAY, 106);
+    CHECK(refreshes == 0 && next_values == 0);
+
+    /* Up to the scale, today only grows its bar */
+    update(DAY, 375);
+    CHECK(refreshes == 0 && next_values == 1);
+    CHECK(points[TODAY_POINT] == HEIGHT);
+
+    /* Past it, the whole series is rescaled */
+    update(DAY, 376);
+    CHECK(refreshes == 1 && next_values == 0);
+    CHECK(scale_max == 376 + 94);
+    CHECK(points[TODAY_POINT] == 376 * HEIGHT / 470);
+    CHECK(points[TODAY_POINT - 1] == 300 * HEIGHT / 470);
+
+    /* At rollover the bars move one day left, small days get the minimum headroom */
+    current.daily_stats_count = 0;
+    set_history(0, DAY, 40);
+    set_history(1, DAY - 1, 20);
+    update(DAY + 1, 0);
+    CHECK(refreshes == 1 && next_values == 0);
+    CHECK(scale_max == 40 + 64);
+    CHECK(points[TODAY_POINT] == 0);
+    CHECK(points[TODAY_POINT - 1] == 40 * HEIGHT / 104);
+    CHECK(points[TODAY_POINT - 2] == 20 * HEIGHT / 104);
+
+    /* Counts whose product with the height overflows 32 bits */
+    update(DAY + 1, 1000000000);
+    CHECK(refreshes == 1);
+    CHECK(points[TODAY_POINT] == (lv_coord_t)(1000000000ULL * HEIGHT / scale_max));
+    CHECK(points[TODAY_POINT] == HEIGHT * 4 / 5);
+
+    return fake_check_result();
+}
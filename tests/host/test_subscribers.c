@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "keystroke_stats.c"
+
+#include "fake_zephyr.h"
+
+#define KEY_INTERVAL_MS 100
+#define DAY_MS (24 * 3600 * 1000LL)
+#define MAX_CALLS 16
+
+static struct zmk_position_state_changed key_event;
+
+struct zmk_position_state_changed *as_zmk_position_state_changed(const zmk_event_t *eh) {
+    return &key_event;
+}
+
+int raise_zmk_keystroke_stats_changed(struct zmk_keystroke_stats_changed ev) { return 0; }
+
+static void type(int keys) {
+    for (int i = 0; i < keys; i++) {
+        fake_now += KEY_INTERVAL_MS;
+        key_event.position = 1;
+        key_event.state = true;
+        keystroke_event_listener(NULL);
+    }
+}
+
+/* Callbacks append their user_data and snapshot here */
+static struct {
+    int id;
+    struct zmk_keystroke_stats stats;
+} calls[MAX_CALLS];
+static int call_count;
+
+static void record(const struct zmk_keystroke_stats *stats, void *user_data) {
+    struct zmk_keystroke_stats current;
+
+    /* Run unlocked, one at a time, and may read the statistics */
+    CHECK(stats_mutex.lock_count == 0);
+    CHECK(notify_mutex.lock_count == 1);
+    CHECK(zmk_keystroke_stats_get(&current) == 0);
+
+    CHECK(call_count < MAX_CALLS);
+    calls[call_count].id = (intptr_t)user_data;
+    calls[call_count].stats = *stats;
+    call_count++;
+}
+
+static struct zmk_keystroke_stats_subscriber subs[4];
+
+static void subscribe(int id, uint8_t interest, uint32_t min_interval_ms) {
+    subs[id] = (struct zmk_keystroke_stats_subscriber){
+        .callback = record,
+        .user_data = (void *)(intptr_t)id,
+        .interest = interest,
+        .min_interval_ms = min_interval_ms,
+    };
+    CHECK(zmk_keystroke_stats_subscribe(&subs[id]) == 0);
+}
+
+static void unsubscribe_all(void) {
+    for (int i = 0; i < ARRAY_SIZE(subs); i++) {
+        zmk_keystroke_stats_unsubscribe(&subs[i]);
+    }
+    call_count = 0;
+}
+
+/* Callbacks since the last check were these, in order */
+static void expect_calls(int count, const int *ids) {
+    CHECK(call_count == count);
+    for (int i = 0; i < count && i < call_count; i++) {
+        CHECK(calls[i].id == ids[i]);
+    }
+    call_count = 0;
+}
+
+#define EXPECT_CALLS(...)                                                                          \
+    do {                                                                                           \
+        const int ids[] = {__VA_ARGS__};                                                           \
+        expect_calls(ARRAY_SIZE(ids), ids);                                                        \
+    } while (0)
+
+#define EXPECT_NO_CALLS() expect_calls(0, NULL)
+
+/* Subscribers are notified in the order they subscribed */
+
+static void record_and_leave(const struct zmk_keystroke_stats *stats, void *user_data) {
+    record(stats, user_data);
+    CHECK(zmk_keystroke_stats_unsubscribe(&subs[3]) == 0);
+}
+
+static void test_order(void) {
+    subscribe(0, 0, 0);
+    subscribe(1, 0, 0);
+    subscribe(2, 0, 0);
+    type(1);
+    EXPECT_CALLS(0, 1, 2);
+
+    CHECK(zmk_keystroke_stats_subscribe(&subs[0]) == -EALREADY);
+    CHECK(zmk_keystroke_stats_unsubscribe(&subs[1]) == 0);
+    CHECK(zmk_keystroke_stats_unsubscribe(&subs[1]) == -ENOENT);
+    type(1);
+    EXPECT_CALLS(0, 2);
+
+    /* Subscribing again goes to the end */
+    CHECK(zmk_keystroke_stats_subscribe(&subs[1]) == 0);
+    type(1);
+    EXPECT_CALLS(0, 2, 1);
+
+    /* A callback may unsubscribe itself, the ones after it still run */
+    CHECK(zmk_keystroke_stats_unsubscribe(&subs[2]) == 0);
+    subs[3] = (struct zmk_keystroke_stats_subscriber){
+        .callback = record_and_leave,
+        .user_data = (void *)3,
+    };
+    CHECK(zmk_keystroke_stats_subscribe(&subs[3]) == 0);
+    CHECK(zmk_keystroke_stats_subscribe(&subs[2]) == 0);
+    type(1);
+    EXPECT_CALLS(0, 1, 3, 2);
+    type(1);
+    EXPECT_CALLS(0, 1, 2);
+
+    subs[2].callback = NULL;
+    CHECK(zmk_keystroke_stats_unsubscribe(&subs[2]) == 0);
+    CHECK(zmk_keystroke_stats_subscribe(&subs[2]) == -EINVAL);
+
+    unsubscribe_all();
+}
+
+/* Subscribers are skipped for changes outside their interest */
+
+static void test_interest(void) {
+    subscribe(0, ZMK_KEYSTROKE_STATS_CHANGED_DAY, 0);
+    subscribe(1, ZMK_KEYSTROKE_STATS_CHANGED_TOTAL, 0);
+    type(1);
+    EXPECT_CALLS(1);
+
+    /* Top keys are left out of snapshots nobody notified asked for */
+    CHECK(calls[0].stats.top_keys[0].count == 0);
+
+    /* A rollover is noticed by a keystroke, which also changes the total */
+    fake_now += DAY_MS;
+    type(1);
+    EXPECT_CALLS(0, 1);
+    CHECK(calls[0].stats.current_uptime_day == state.current_uptime_day);
+    CHECK(calls[0].stats.daily_stats_count == 0);
+
+    /* History is filled when someone notified asked for it */
+    subscribe(2, ZMK_KEYSTROKE_STATS_CHANGED_HISTORY | ZMK_KEYSTROKE_STATS_CHANGED_KEYS, 0);
+    fake_now += DAY_MS;
+    type(1);
+    EXPECT_CALLS(0, 1, 2);
+    CHECK(calls[2].stats.daily_stats_count == state.daily_history_count);
+    CHECK(calls[2].stats.daily_stats_count > 0);
+    CHECK(calls[2].stats.top_keys[0].count == state.key_counts[1]);
+
+    unsubscribe_all();
+}
+
+/* Changes within min_interval_ms are folded into one notification at its end */
+
+static void test_min_interval(void) {
+    subscribe(0, 0, 1000);
+    subscribe(1, 0, 0);
+
+    /* The first change is not held back */
+    type(1);
+    EXPECT_CALLS(0, 1);
+    CHECK(!k_work_delayable_is_pending(&notify_work));
+
+    type(3);
+    EXPECT_CALLS(1, 1, 1);
+    CHECK(k_work_delayable_is_pending(&notify_work));
+    CHECK(notify_work.delay_ms == 1000 - 3 * KEY_INTERVAL_MS);
+
+    /* Due when the interval since the last notification is over */
+    fake_now += 1000 - 3 * KEY_INTERVAL_MS;
+    CHECK(fake_work_run(&notify_work));
+    EXPECT_CALLS(0);
+    CHECK(calls[0].stats.total_keystrokes == state.total_keystrokes);
+    CHECK(!k_work_delayable_is_pending(&notify_work));
+
+    /* Nothing changed since, nothing held back */
+    fake_now += 1000;
+    CHECK(!fake_work_run(&notify_work));
+    type(1);
+    EXPECT_CALLS(0, 1);
+
+    unsubscribe_all();
+}
+
+/* Only changes of interest are kept pending, and cleared once notified */
+
+static void test_pending(void) {
+    subscribe(0, ZMK_KEYSTROKE_STATS_CHANGED_TOTAL | ZMK_KEYSTROKE_STATS_CHANGED_DAY, 1000);
+    subscribe(1, ZMK_KEYSTROKE_STATS_CHANGED_HISTORY, 1000);
+    type(1);
+    EXPECT_CALLS(0);
+    CHECK(subs[0].pending == 0);
+
+    type(1);
+    EXPECT_NO_CALLS();
+    CHECK(subs[0].pending == ZMK_KEYSTROKE_STATS_CHANGED_TOTAL);
+    CHECK(subs[1].pending == 0);
+
+    /* Subscriber 1 was never notified, so history changing makes it due at once */
+    fake_now += DAY_MS;
+    type(1);
+    EXPECT_CALLS(0, 1);
+    CHECK(subs[0].pending == 0 && subs[1].pending == 0);
+
+    /* Reset changes everything, but only interests are pending */
+    type(1);
+    CHECK(zmk_keystroke_stats_reset(false) == 0);
+    CHECK(subs[0].pending ==
+          (ZMK_KEYSTROKE_STATS_CHANGED_TOTAL | ZMK_KEYSTROKE_STATS_CHANGED_DAY));
+    CHECK(subs[1].pending == ZMK_KEYSTROKE_STATS_CHANGED_HISTORY);
+
+    unsubscribe_all();
+}
+
+/* The deprecated callback API holds CONFIG_ZMK_KEYSTROKE_STATS_MAX_CALLBACKS */
+
+static void legacy_a(const struct zmk_keystroke_stats *stats, void *user_data) {
+    record(stats, user_data);
+}
+
+static void legacy_b(const struct zmk_keystroke_stats *stats, void *user_data) {
+    record(stats, user_data);
+}
+
+static void test_legacy(void) {
+    CHECK(zmk_keystroke_stats_register_callback(NULL, NULL) == -EINVAL);
+
+    for (int i = 0; i < CONFIG_ZMK_KEYSTROKE_STATS_MAX_CALLBACKS; i++) {
+        CHECK(zmk_keystroke_stats_register_callback(legacy_a, (void *)(intptr_t)i) == 0);
+    }
+    CHECK(zmk_keystroke_stats_register_callback(legacy_b, NULL) == -ENOMEM);
+
+    type(1);
+    CHECK(call_count == CONFIG_ZMK_KEYSTROKE_STATS_MAX_CALLBACKS);
+    call_count = 0;
+
+    /* Unregistering frees a slot */
+    CHECK(zmk_keystroke_stats_unregister_callback(legacy_b) == -ENOENT);
+    CHECK(zmk_keystroke_stats_unregister_callback(legacy_a) == 0);
+    CHECK(zmk_keystroke_stats_register_callback(legacy_b, NULL) == 0);
+
+    for (int i = 0; i < CONFIG_ZMK_KEYSTROKE_STATS_MAX_CALLBACKS - 1; i++) {
+        CHECK(zmk_keystroke_stats_unregister_callback(legacy_a) == 0);
+    }
+    CHECK(zmk_keystroke_stats_unregister_callback(legacy_b) == 0);
+    CHECK(zmk_keystroke_stats_unregister_callback(legacy_a) == -ENOENT);
+
+    type(1);
+    EXPECT_NO_CALLS();
+}
+
+int main(void) {
+    fake_now = 1000;
+    keystroke_stats_init();
+
+    test_order();
+    test_interest();
+    test_min_interval();
+    test_pending();
+    test_legacy();
+
+    return fake_check_result();
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2025 zmk-keystroke-stats contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "keystroke_stats_time.c"
+
+#include "fake_zephyr.h"
+
+/* Consecutive dates have consecutive day numbers, which convert back */
+static void check_round_trip(uint16_t first_year, uint16_t last_year) {
+    uint16_t expected = zmk_keystroke_stats_date_to_day(first_year, 1, 1);
+
+    for (uint16_t year = first_year; year <= last_year; year++) {
+        for (uint8_t month = 1; month <= 12; month++) {
+            for (uint8_t mday = 1; mday <= days_in_month(year, month); mday++) {
+                uint16_t day = zmk_keystroke_stats_date_to_day(year, month, mday);
+                uint16_t y;
+                uint8_t m, d;
+
+                CHECK(day == expected);
+                expected++;
+                if (keystroke_stats_day_is_calendar(day)) {
+                    CHECK(zmk_keystroke_stats_day_to_date(day, &y, &m, &d) == 0);
+                    CHECK(y == year && m == month && d == mday);
+                }
+            }
+        }
+    }
+}
+
+int main(void) {
+    CHECK(zmk_keystroke_stats_date_to_day(1970, 1, 1) == 0);
+    CHECK(zmk_keystroke_stats_date_to_day(2025, 1, 1) == 20089);
+
+    /* Days past the end of the month */
+    CHECK(zmk_keystroke_stats_date_to_day(2025, 2, 31) == 0);
+    CHECK(zmk_keystroke_stats_date_to_day(2025, 2, 29) == 0);
+    CHECK(zmk_keystroke_stats_date_to_day(2025, 4, 31) == 0);
+    CHECK(zmk_keystroke_stats_date_to_day(2025, 11, 31) == 0);
+    CHECK(zmk_keystroke_stats_date_to_day(2025, 0, 1) == 0);
+    CHECK(zmk_keystroke_stats_date_to_day(2025, 13, 1) == 0);
+
+    /* Leap days, every fourth year except centuries not divisible by 400 */
+    CHECK(zmk_keystroke_stats_date_to_day(2024, 2, 29) ==
+          zmk_keystroke_stats_date_to_day(2024, 3, 1) - 1);
+    CHECK(zmk_keystroke_stats_date_to_day(2000, 2, 29) ==
+          zmk_keystroke_stats_date_to_day(2000, 3, 1) - 1);
+    CHECK(zmk_keystroke_stats_date_to_day(2100, 2, 29) == 0);
+
+    /* Day numbers run out in 2149 */
+    check_round_trip(1970, 2148);
+    CHECK(zmk_keystroke_stats_date_to_day(2150, 1, 1) == 0);
+
+    return fake_check_result();
+}